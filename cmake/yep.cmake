@@ -3,22 +3,90 @@
 #
 # Licensed under the MIT license. See LICENSE file in the project root for details.
 
+# pack_resources(<input_dir> <output_file> <target_name> [REPORT <report.json>] [HEADER <ids.h>] [ARGS <yep pack options>...])
+#
+#   REPORT  also write a JSON report of per entry sizes, ratios and compression times
+#   HEADER  also write a C header of entry ids and hashes for yep_extract_by_id(), list it
+#           in a target's sources so it is generated before that target compiles
+#   ARGS    extra options passed to yep, ie: ARGS --images --mips
+#
+# Inputs are tracked through a depfile yep writes while packing, so edited, added and
+# removed files rerun the pack without reconfiguring. <output_file>.cache lets that run
+# reuse every entry whose source did not change.
 function(pack_resources INPUT_DIR OUTPUT_FILE TARGET_NAME)
+    cmake_parse_arguments(PACK "" "REPORT;HEADER" "ARGS" ${ARGN})
+
+    # depfile paths are matched against the outputs, so keep everything absolute
     file(TO_CMAKE_PATH "${INPUT_DIR}" INPUT_DIR)
-    file(GLOB_RECURSE RESOURCE_INPUT_FILES
-        CONFIGURE_DEPENDS
-        "${INPUT_DIR}/*"
-    )
+    cmake_path(ABSOLUTE_PATH INPUT_DIR NORMALIZE)
+    cmake_path(ABSOLUTE_PATH OUTPUT_FILE BASE_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}" NORMALIZE)
+
+    set(PACK_DEPFILE "${OUTPUT_FILE}.d")
+    set(PACK_CACHE "${OUTPUT_FILE}.cache")
+
+    set(PACK_EXTRA_ARGS ${PACK_ARGS} --depfile "${PACK_DEPFILE}" --cache "${PACK_CACHE}")
+    set(PACK_BYPRODUCTS "${PACK_CACHE}")
+    set(PACK_OUTPUTS "${OUTPUT_FILE}")
+    if(PACK_REPORT)
+        list(APPEND PACK_EXTRA_ARGS --report "${PACK_REPORT}")
+        list(APPEND PACK_BYPRODUCTS "${PACK_REPORT}")
+    endif()
+    if(PACK_HEADER)
+        list(APPEND PACK_EXTRA_ARGS --header "${PACK_HEADER}")
+        list(APPEND PACK_OUTPUTS "${PACK_HEADER}")
+    endif()
 
     add_custom_command(
-        OUTPUT "${OUTPUT_FILE}"
-        COMMAND $<TARGET_FILE:yep> "${INPUT_DIR}" "${OUTPUT_FILE}"
-        DEPENDS yep ${RESOURCE_INPUT_FILES}
+        OUTPUT ${PACK_OUTPUTS}
+        BYPRODUCTS ${PACK_BYPRODUCTS}
+        COMMAND $<TARGET_FILE:yep> ${PACK_EXTRA_ARGS} "${INPUT_DIR}" "${OUTPUT_FILE}"
+        DEPENDS yep
+        DEPFILE "${PACK_DEPFILE}"
         COMMENT "Packing resources from ${INPUT_DIR} to ${OUTPUT_FILE}"
         VERBATIM
     )
 
     add_custom_target(${TARGET_NAME}
-        DEPENDS "${OUTPUT_FILE}"
+        DEPENDS ${PACK_OUTPUTS}
+    )
+endfunction()
+
+set(YEP_EMBED_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/yep_embed.cmake")
+
+# embed_pack(<pack_file> <symbol> <target_name> [DEPENDS <pack target>])
+#
+#   Links a pack into <target_name> and generates a function returning its bytes:
+#       const void *<symbol>(size_t *size);
+#
+#   Register it once at startup and every open of that path reads from memory:
+#       size_t size;
+#       const void *data = resources_pack(&size);
+#       yep_register_embedded_pack("resources.yep", data, size);
+#
+#   DEPENDS  the target that produces the pack (ie: the pack_resources target name)
+function(embed_pack PACK_FILE SYMBOL TARGET_NAME)
+    cmake_parse_arguments(EMBED "" "DEPENDS" "" ${ARGN})
+
+    get_filename_component(PACK_FILE "${PACK_FILE}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+    set(EMBED_SOURCE "${CMAKE_CURRENT_BINARY_DIR}/${SYMBOL}_embed.c")
+
+    # msvc has no inline assembler for x64, so it gets a (slower to generate) byte array
+    if(MSVC)
+        set(EMBED_MODE array)
+    else()
+        set(EMBED_MODE incbin)
+    endif()
+
+    add_custom_command(
+        OUTPUT "${EMBED_SOURCE}"
+        COMMAND ${CMAKE_COMMAND} -DINPUT=${PACK_FILE} -DOUTPUT=${EMBED_SOURCE} -DSYMBOL=${SYMBOL} -DMODE=${EMBED_MODE} -P "${YEP_EMBED_SCRIPT}"
+        DEPENDS "${PACK_FILE}" "${YEP_EMBED_SCRIPT}"
+        COMMENT "Embedding ${PACK_FILE} into ${TARGET_NAME}"
+        VERBATIM
     )
-endfunction()
\ No newline at end of file
+
+    target_sources(${TARGET_NAME} PRIVATE "${EMBED_SOURCE}")
+    if(EMBED_DEPENDS)
+        add_dependencies(${TARGET_NAME} ${EMBED_DEPENDS})
+    endif()
+endfunction()
@@ -0,0 +1,87 @@
+# This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+# Copyright (C) 2023-2025  Ryan Zmuda
+#
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+
+# Script mode helper for embed_pack(), writes a C source exposing a pack as
+#   const void *<SYMBOL>(size_t *size);
+#
+# cmake -DINPUT=<pack.yep> -DOUTPUT=<file.c> -DSYMBOL=<name> -DMODE=<incbin|array> -P yep_embed.cmake
+
+if(NOT EXISTS "${INPUT}")
+    message(FATAL_ERROR "yep_embed: ${INPUT} does not exist")
+endif()
+
+if(MODE STREQUAL "incbin")
+    # the assembler pulls the file in, so the source only changes when the path does
+    file(TO_CMAKE_PATH "${INPUT}" INPUT)
+    file(WRITE "${OUTPUT}.tmp" "\
+/* generated by yep_embed.cmake from ${INPUT}, do not edit */
+
+#include <stddef.h>
+
+#if defined(__APPLE__)
+    #define YEP_EMBED_SECTION \".const_data\"
+    #define YEP_EMBED_NAME(n) \"_\" #n
+#elif defined(_WIN32)
+    #define YEP_EMBED_SECTION \".section .rdata,\\\"dr\\\"\"
+    #if defined(__i386__)
+        #define YEP_EMBED_NAME(n) \"_\" #n
+    #else
+        #define YEP_EMBED_NAME(n) #n
+    #endif
+#else
+    #define YEP_EMBED_SECTION \".section .rodata\"
+    #define YEP_EMBED_NAME(n) #n
+#endif
+
+__asm__(
+    YEP_EMBED_SECTION \"\\n\"
+    \".balign 16\\n\"
+    YEP_EMBED_NAME(${SYMBOL}_begin) \":\\n\"
+    \".incbin \\\"${INPUT}\\\"\\n\"
+    YEP_EMBED_NAME(${SYMBOL}_end) \":\\n\"
+    \".text\\n\"
+);
+
+extern const unsigned char ${SYMBOL}_begin[];
+extern const unsigned char ${SYMBOL}_end[];
+
+const void *${SYMBOL}(size_t *size) {
+    *size = (size_t)(${SYMBOL}_end - ${SYMBOL}_begin);
+    return ${SYMBOL}_begin;
+}
+")
+else()
+    # portable fallback (MSVC has no incbin), much slower to generate for big packs
+    file(READ "${INPUT}" PACK_HEX HEX)
+    string(LENGTH "${PACK_HEX}" PACK_HEX_LENGTH)
+    math(EXPR PACK_SIZE "${PACK_HEX_LENGTH} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," PACK_BYTES "${PACK_HEX}")
+    string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],){32})" "\\1\n" PACK_BYTES "${PACK_BYTES}")
+
+    file(WRITE "${OUTPUT}.tmp" "\
+/* generated by yep_embed.cmake from ${INPUT}, do not edit */
+
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+    #define YEP_EMBED_ALIGN __declspec(align(16))
+#else
+    #define YEP_EMBED_ALIGN __attribute__((aligned(16)))
+#endif
+
+// one extra byte so empty packs still make a valid array
+static YEP_EMBED_ALIGN const unsigned char ${SYMBOL}_data[${PACK_SIZE} + 1] = {
+${PACK_BYTES}
+0 };
+
+const void *${SYMBOL}(size_t *size) {
+    *size = ${PACK_SIZE};
+    return ${SYMBOL}_data;
+}
+")
+endif()
+
+# always touch the output, the build reruns us exactly when the pack changed
+file(RENAME "${OUTPUT}.tmp" "${OUTPUT}")
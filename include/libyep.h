@@ -14,17 +14,7 @@
 #include <string.h>     // string functions
 #include <stdlib.h>     // malloc
 
-/*
-    Trivial temp logger
-*/
-enum yep_log_level {
-    yep_log_debug,
-    yep_log_info,
-    yep_log_warning,
-    yep_log_error,
-};
-
-void yep_logf(enum yep_log_level level, const char *fmt, ...);
+#include "yeplog.h"     // logging
 
 /*
     Details on the file format:
@@ -52,19 +42,26 @@ void yep_logf(enum yep_log_level level, const char *fmt, ...);
 
 #define YEP_HEADER_SIZE_BYTES 78
 
+// uncompressed entries start at a multiple of this, so views into the pack are aligned
+#define YEP_DATA_ALIGNMENT 8
+
 // #define YEP_VERSION_NUMBER_SIZE 1   // uint8_t
 // #define YEP_ENTRY_COUNT_SIZE 2      // uint16_t
 
 enum YEP_DATATYPE {
     YEP_DATATYPE_MISC,          // loose files, .yoyo .txt etc
-    YEP_DATATYPE_IMAGE,         // dont need to differentiate formats because it will be a pixel array from SDL_Image
-    YEP_DATATYPE_PCM,           // raw PCM data from SDL_Mixer
-    YEP_DATATYPE_LUA_BYTECODE,  // lua bytecode (DO NOT COMPRESS)
+    YEP_DATATYPE_IMAGE,         // RGBA pixel array decoded by SDL_Image at pack time (see IMAGE PAYLOADS)
+    YEP_DATATYPE_PCM,           // interleaved S16 samples decoded by SDL at pack time (see AUDIO PAYLOADS)
+    YEP_DATATYPE_LUA_BYTECODE,  // stripped lua bytecode compiled at pack time (DO NOT COMPRESS, see yep_pack_view)
+    YEP_DATATYPE_ANIMATION,     // numbered frame sequence bundled into one entry (see ANIMATION PAYLOADS)
+    YEP_DATATYPE_ATLAS,         // region table of a texture atlas (DO NOT COMPRESS, see yep_pack_find_region)
 };
 
 enum YEP_COMPRESSION {
     YEP_COMPRESSION_NONE,   // no compression
     YEP_COMPRESSION_ZLIB,   // zlib compression
+    YEP_COMPRESSION_LPC,    // lossless linear prediction + rice coding, only for YEP_DATATYPE_PCM payloads
+    YEP_COMPRESSION_FILTERED_ZLIB, // png style per row prediction, then zlib, only for YEP_DATATYPE_IMAGE payloads
 };
 
 /*
@@ -82,6 +79,15 @@ enum YEP_COMPRESSION {
  */
 struct yep_data_info yep_extract_data(const char *file, const char *handle);
 
+/**
+ * @brief Closes the pack kept open by the legacy API if it was repacked (ie: by yep watch) or its mounted directory changed
+ * 
+ * Costs one stat, so it can be called every frame. The next extract opens the new pack.
+ * 
+ * @return true if the pack changed on disk
+ */
+bool yep_refresh_packs(void);
+
 /**
  * @brief Packs a given directory into a .yep, if the target directory is newer than the last pack, based on its dir name
  * 
@@ -102,6 +108,62 @@ bool yep_pack_directory(char *directory_path, char *output_name);
  */
 bool yep_force_pack_directory(char *directory_path, char *output_name);
 
+/*
+    Packing options
+*/
+
+struct yep_pack_progress {
+    uint32_t entries_done;      // entries written so far
+    uint32_t entries_total;     // entries that will be written
+    uint64_t bytes_in;          // raw bytes read from the source files so far
+    uint64_t bytes_out;         // bytes written to the pack data section so far
+    const char *current;        // name of the most recently written entry
+};
+
+/**
+ * @brief Called by the packer to report progress, never more often than the configured interval
+ * (the final entry is always reported)
+ */
+typedef void (*yep_progress_fn)(const struct yep_pack_progress *progress, void *userdata);
+
+struct yep_pack_options {
+    yep_progress_fn progress_callback;  // NULL for no progress reporting
+    void *progress_userdata;
+    uint32_t progress_interval_ms;      // minimum time between progress callbacks
+
+    bool decode_images;                 // store images as raw RGBA (YEP_DATATYPE_IMAGE), needs YEP_IMAGE_SUPPORT
+    bool image_mips;                    // also store a full mip chain for decoded images
+    bool decode_audio;                  // store wav files as raw PCM (YEP_DATATYPE_PCM) compressed with YEP_COMPRESSION_LPC
+    bool compile_lua;                   // store .lua files as bytecode (YEP_DATATYPE_LUA_BYTECODE), needs YEP_LUA_SUPPORT
+    bool lua_debug_info;                // keep line info and the handle as chunk name in the bytecode, for readable stack traces
+    bool bundle_animations;             // fold numbered frame sequences into one YEP_DATATYPE_ANIMATION entry
+    bool animation_delta;               // store decoded image frames as the difference to the previous frame
+
+    // images no larger than this (in pixels) are packed into per directory atlases, 0 (the default) disables.
+    // an atlased image is no longer an entry: yep_pack_find() and yep_extract_data() fail for its
+    // handle, which only resolves through yep_pack_find_region()
+    uint32_t atlas_max_size;
+    uint32_t atlas_page_size;           // maximum width and height of an atlas page
+
+    const char *report_path;            // write a JSON report of sizes, ratios and compression times here (NULL for none)
+    const char *header_path;            // write a C header of entry ids and hashes here (NULL for none), see yep_write_id_header
+
+    const char *cache_path;             // reuse unchanged entries of the previous pack, tracked in this file (NULL to always pack everything)
+    const char *depfile_path;           // write a Make/Ninja depfile of every input file and directory here (NULL for none)
+};
+
+/**
+ * @brief Fills out a set of options with the defaults
+ */
+void yep_pack_options_init(struct yep_pack_options *options);
+
+/**
+ * @brief Sets the options used by every following pack call (copied, NULL resets to defaults)
+ * 
+ * NOTE: strings are not copied, they must stay valid while packing
+ */
+void yep_set_pack_options(const struct yep_pack_options *options);
+
 /**
  * @brief Checks if a yep item exists in the file
  * 
@@ -112,6 +174,283 @@ bool yep_force_pack_directory(char *directory_path, char *output_name);
  */
 bool yep_item_exists(const char *file, const char *handle);
 
+/*
+    =========================
+    |      PACK HANDLES     |
+    =========================
+
+    A pack handle maps the whole file and parses its header table once, after that a lookup
+    is a hash probe and an extraction is a copy (or inflate) straight out of the mapping.
+    Lookups and extractions through the same handle are safe from multiple threads.
+*/
+
+struct yep_entry {
+    char name[64];
+    uint32_t offset;
+    uint32_t size;
+    uint8_t compression_type;
+    uint32_t uncompressed_size;
+    uint8_t data_type;
+};
+
+struct yep_pack;
+
+/**
+ * @brief Opens and indexes a yep file
+ * 
+ * @param file The path to the yep file
+ * @return struct yep_pack* The pack handle (NULL on failure)
+ */
+struct yep_pack *yep_pack_open(const char *file);
+
+/**
+ * @brief Opens and indexes a pack that is already in memory, ie: embedded with embed_pack() in cmake/yep.cmake
+ * 
+ * @param data The pack bytes, not copied, they must stay valid until the handle is closed
+ * @param size The size of the pack
+ * @param name Used as the pack path in messages and yep_pack_path(), NULL for "<memory>"
+ * @return struct yep_pack* The pack handle (NULL on failure)
+ */
+struct yep_pack *yep_pack_open_memory(const void *data, size_t size, const char *name);
+
+/**
+ * @brief Shares the index and decoded entries of packs between processes on the same machine
+ * 
+ * Applies to pack files opened after the call (not embedded packs or mounted directories).
+ * The first process to open a version of a pack parses it into named shared memory, later
+ * processes attach to that instead. Compressed entries are decoded into a shared cache of
+ * cache_size bytes the first time any process extracts them, after that yep_pack_view()
+ * works for them as well. Nothing is evicted, entries that do not fit stay private.
+ * 
+ * Segments outlive the processes on POSIX systems, see yep_pack_unlink_shared().
+ * 
+ * @param enabled false goes back to a private index per handle
+ * @param cache_size Bytes of shared cache per pack, 0 only shares the index
+ */
+void yep_use_shared_memory(bool enabled, size_t cache_size);
+
+/**
+ * @brief Removes the shared memory segment of the current version of a pack file, ie: after a
+ * session or before shipping a new build. Processes that have it open keep working.
+ * 
+ * @return true if a segment was removed
+ */
+bool yep_pack_unlink_shared(const char *file);
+
+/**
+ * @brief Makes every following open of file (by yep_pack_open() or the legacy API) use the given
+ * bytes instead of reading the disk. Registrations last for the lifetime of the process.
+ * 
+ * @param file The path the pack would otherwise be loaded from, ie: "resources.yep"
+ * @param data The pack bytes, not copied
+ * @param size The size of the pack
+ * @return true on success
+ */
+bool yep_register_embedded_pack(const char *file, const void *data, size_t size);
+
+/**
+ * @brief Serves every following open of file from a loose directory instead of the pack, for development
+ * 
+ * The handle works like a pack built from that directory without any stages: entry names,
+ * ids and yep_extract_by_id() match, every entry is YEP_DATATYPE_MISC and is read from disk
+ * when extracted. On Linux the handle turns stale (see yep_refresh_packs()) when files are
+ * added or removed, elsewhere reopen it to see them.
+ * 
+ * @param file The pack path to replace, ie: "resources.yep"
+ * @param directory The directory to serve, NULL goes back to the pack file
+ * @return true on success
+ */
+bool yep_mount_directory(const char *file, const char *directory);
+
+/**
+ * @brief Closes a pack handle (NULL is ignored)
+ */
+void yep_pack_close(struct yep_pack *pack);
+
+/**
+ * @brief Checks if the file a pack was opened from has been repacked since
+ * 
+ * The handle keeps serving the old contents until it is closed and opened again.
+ * Packs opened from memory are never stale.
+ */
+bool yep_pack_is_stale(const struct yep_pack *pack);
+
+enum yep_change_kind {
+    YEP_CHANGE_MODIFIED,
+    YEP_CHANGE_ADDED,
+    YEP_CHANGE_REMOVED,
+};
+
+struct yep_pack_change {
+    uint8_t kind;           // YEP_CHANGE_*
+    uint32_t id;            // index in the new pack (UINT32_MAX if removed)
+    uint32_t old_id;        // index in the old pack (UINT32_MAX if added)
+    uint64_t hash;          // yep_hash_handle() of the name, the same in both packs
+    const char *name;
+};
+
+/**
+ * @brief Called with every entry whose stored bytes differ between the old and the new pack
+ * 
+ * @param pack The new pack, ids in changes index into it
+ * @param changes Only valid during the call
+ */
+typedef void (*yep_reload_fn)(const struct yep_pack *pack, const struct yep_pack_change *changes, uint32_t count, void *userdata);
+
+/**
+ * @brief Lists the entries that were modified, added or removed between two packs
+ * 
+ * Entries are matched by name and compared by their stored bytes.
+ * 
+ * @param changes Receives an array allocated into the heap (YOU MUST FREE IT), names point into the packs
+ * @return uint32_t The number of changes
+ */
+uint32_t yep_pack_diff(const struct yep_pack *old_pack, const struct yep_pack *new_pack, struct yep_pack_change **changes);
+
+/**
+ * @brief Swaps a stale pack handle (see yep_pack_is_stale()) for the new pack and reports what changed
+ * 
+ * Costs one stat if nothing changed. The old handle is closed after the callback returns.
+ * 
+ * @param pack The handle to check, replaced by the new one on reload
+ * @param callback Receives the changed entries (NULL to only reload)
+ * @return true if the pack was reloaded
+ */
+bool yep_pack_reload(struct yep_pack **pack, yep_reload_fn callback, void *userdata);
+
+/**
+ * @brief Makes yep_refresh_packs() reload the legacy pack right away and report its changed entries
+ * 
+ * Ids and hashes in the callback match those of a generated id header for the pack.
+ * 
+ * @param callback NULL goes back to closing the pack and reopening it on the next extract
+ */
+void yep_set_reload_callback(yep_reload_fn callback, void *userdata);
+
+/**
+ * @brief The path the pack was opened from
+ */
+const char *yep_pack_path(const struct yep_pack *pack);
+
+/**
+ * @brief The format version byte of the pack (a mounted directory reports the current version)
+ */
+uint8_t yep_pack_version(const struct yep_pack *pack);
+
+/**
+ * @brief The number of entries in the pack
+ */
+uint32_t yep_pack_entry_count(const struct yep_pack *pack);
+
+/**
+ * @brief Gets the header of an entry by index (NULL if out of range)
+ */
+const struct yep_entry *yep_pack_entry(const struct yep_pack *pack, uint32_t index);
+
+/**
+ * @brief Looks up an entry by name
+ * 
+ * @return int32_t The entry index, or -1 if the handle does not exist
+ */
+int32_t yep_pack_find(const struct yep_pack *pack, const char *handle);
+
+/**
+ * @brief Looks up an entry by a precomputed yep_hash_handle() of its name
+ * 
+ * NOTE: the name is not compared, two names with the same 64 bit hash cannot be told apart
+ * 
+ * @return int32_t The entry index, or -1 if no entry has that hash
+ */
+int32_t yep_pack_find_hash(const struct yep_pack *pack, uint64_t hash);
+
+/**
+ * @brief Hash of every entry name in index order, equal packs have equal ids
+ * 
+ * Compare against the <PACK>_FINGERPRINT of a generated id header to check it is current
+ */
+uint64_t yep_pack_fingerprint(const struct yep_pack *pack);
+
+/**
+ * @brief Extracts (and decompresses) an entry by index
+ * 
+ * @return struct yep_data_info The data allocated into the heap (NULL if it could not be read)
+ * 
+ * !!! YOU MUST FREE THE DATA YOURSELF WHEN YOU ARE DONE WITH IT !!!
+ */
+struct yep_data_info yep_pack_extract(const struct yep_pack *pack, uint32_t index);
+
+/**
+ * @brief Borrows an uncompressed entry straight out of the mapping, no copy is made
+ * 
+ * Lua bytecode entries are never compressed, so they can always be loaded this way:
+ * luaL_loadbufferx(L, view, size, name, "b")
+ * 
+ * Compressed entries can only be viewed with yep_use_shared_memory(), which decodes them into the shared cache.
+ * 
+ * @param size Receives the size of the entry
+ * @return const void* The entry data, valid until the pack is closed (NULL if the entry is compressed and not
+ * shared, out of range or in a mounted directory)
+ */
+const void *yep_pack_view(const struct yep_pack *pack, uint32_t index, size_t *size);
+
+/**
+ * @brief Extracts an entry using the constants of a generated id header, no strings involved
+ * 
+ * ie: yep_extract_by_id(pack, RESOURCES_UI_BUTTON_PNG_ID, RESOURCES_UI_BUTTON_PNG_HASH)
+ * 
+ * The id is checked against the hash first, if the pack changed since the header was
+ * generated the entry is found through the hash instead.
+ * 
+ * !!! YOU MUST FREE THE DATA YOURSELF WHEN YOU ARE DONE WITH IT !!!
+ */
+struct yep_data_info yep_extract_by_id(const struct yep_pack *pack, uint32_t id, uint64_t hash);
+
+/**
+ * @brief Writes a C header with the id, hash, size and type of every entry in a pack
+ * 
+ * Macros are named after the pack file and the entry, ie: resources.yep and ui/button.png
+ * give RESOURCES_UI_BUTTON_PNG_ID, _HASH, _SIZE and _TYPE
+ * 
+ * @param pack_file The pack to describe
+ * @param header_file Where to write the header
+ * @return true if the header was written
+ */
+bool yep_write_id_header(const char *pack_file, const char *header_file);
+
+struct yep_atlas_region {
+    uint32_t page;              // entry index of the atlas page image
+    uint32_t x;                 // rectangle in pixels
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    float u0, v0, u1, v1;       // the same rectangle in normalized page coordinates
+};
+
+/**
+ * @brief Resolves the original handle of an image that was packed into an atlas, the only
+ * lookup that still finds it (see yep_pack_options.atlas_max_size)
+ * 
+ * @param handle The name the image had on disk, ie: ui/button.png
+ * @param out Receives the page entry and the image rectangle within it
+ * @return true if the handle is an atlas region
+ */
+bool yep_pack_find_region(const struct yep_pack *pack, const char *handle, struct yep_atlas_region *out);
+
+/**
+ * @brief The hash used to index entry names (64 bit FNV-1a)
+ */
+uint64_t yep_hash_handle(const char *handle);
+
+/**
+ * @brief Human readable name of a YEP_COMPRESSION value
+ */
+const char *yep_compression_name(uint8_t compression_type);
+
+/**
+ * @brief Human readable name of a YEP_DATATYPE value
+ */
+const char *yep_datatype_name(uint8_t data_type);
+
 // extract data will call private functions
 // _yep_open_file(char *file); which will open the file into the yep global file pointer
 // _yep_close_file(); which will close the file on shutdown
@@ -137,6 +476,10 @@ struct yep_header_node {
     uint8_t compression_type;
     uint8_t data_type;
 
+    struct yep_header_node *frames; // animation frames folded into this entry, in order (NULL otherwise)
+    char *payload;                  // generated payload of type data_type, used instead of fullpath (NULL otherwise)
+    uint32_t payload_size;
+
     struct yep_header_node *next;
 };
 
@@ -169,4 +512,209 @@ struct yep_data_info yep_resource_misc(const char *handle);
 
 struct yep_data_info yep_engine_resource_misc(const char *handle);
 
+/*
+    =========================
+    |      ASSET SERVER     |
+    =========================
+
+    `yep serve <socket> [pack.yep...]` keeps packs open and warm for short lived tools.
+    A client asks it for an entry and gets the payload as a file descriptor it maps, so
+    nothing is copied through the socket: uncompressed entries come straight out of the
+    pack file, compressed ones out of an in-memory file the server decoded them into once.
+
+    Only available on POSIX systems, the client calls fail elsewhere.
+*/
+
+struct yep_client;
+
+struct yep_served_entry {
+    const void *data;           // read-only, valid until yep_client_release()
+    size_t size;
+    uint8_t data_type;
+
+    void *mapping;              // private
+    size_t mapping_size;
+};
+
+/**
+ * @brief Connects to a running `yep serve`
+ * 
+ * @param socket_path The socket the server was started with
+ * @return struct yep_client* The connection (NULL if no server is listening there)
+ */
+struct yep_client *yep_client_connect(const char *socket_path);
+
+/**
+ * @brief Extracts an entry through the server, which opens the pack on first use and reopens it once it is repacked
+ * 
+ * @param pack Path to the pack file, relative paths are resolved against the working directory of the client
+ * @param handle The name of the entry
+ * @param out Receives the payload, release it with yep_client_release()
+ * @return true on success
+ */
+bool yep_client_extract(struct yep_client *client, const char *pack, const char *handle, struct yep_served_entry *out);
+
+/**
+ * @brief Unmaps a payload received with yep_client_extract()
+ */
+void yep_client_release(struct yep_served_entry *entry);
+
+/**
+ * @brief Closes the connection (NULL is ignored), payloads stay valid until they are released
+ */
+void yep_client_close(struct yep_client *client);
+
+/*
+    =========================
+    |     IMAGE PAYLOADS    |
+    =========================
+
+    YEP_DATATYPE_IMAGE entries hold a yep_image_header followed by tightly packed pixels for
+    each mip level, every level half the size of the previous one (rounded down, min 1).
+    Pixels can be handed straight to SDL_CreateSurfaceFrom(w, h, SDL_PIXELFORMAT_RGBA32, ...)
+    or a texture upload.
+*/
+
+#define YEP_IMAGE_MAGIC 0x474D4959u // "YIMG"
+#define YEP_IMAGE_MAX_MIPS 16
+
+enum YEP_PIXEL_FORMAT {
+    YEP_PIXEL_FORMAT_RGBA8,     // 4 bytes per pixel, R G B A in memory order
+};
+
+struct yep_image_header {
+    uint32_t magic;
+    uint32_t width;
+    uint32_t height;
+    uint8_t format;             // YEP_PIXEL_FORMAT
+    uint8_t mip_count;          // at least 1
+    uint8_t flags;
+    uint8_t reserved;
+};
+
+struct yep_image {
+    uint32_t width;
+    uint32_t height;
+    uint8_t format;
+    uint8_t mip_count;
+
+    struct {
+        uint32_t width;
+        uint32_t height;
+        const uint8_t *pixels;  // points into the payload, no copy is made
+    } mips[YEP_IMAGE_MAX_MIPS];
+};
+
+/**
+ * @brief Parses an image payload without copying it
+ * 
+ * @param data The payload of a YEP_DATATYPE_IMAGE entry
+ * @param size The size of the payload
+ * @param out Receives the dimensions and pointers to each mip level
+ * @return true on success, false if the payload is not a valid image
+ */
+bool yep_image_parse(const void *data, size_t size, struct yep_image *out);
+
+/*
+    =========================
+    |     AUDIO PAYLOADS    |
+    =========================
+
+    YEP_DATATYPE_PCM entries hold a yep_audio_header followed by interleaved little endian
+    signed 16 bit samples, which is what SDL_AUDIO_S16 streams and the mixer consume directly.
+    They are stored with YEP_COMPRESSION_LPC, extraction returns the decoded payload.
+*/
+
+#define YEP_AUDIO_MAGIC 0x4D435059u // "YPCM"
+
+enum YEP_SAMPLE_FORMAT {
+    YEP_SAMPLE_FORMAT_S16,      // signed 16 bit, little endian, interleaved
+};
+
+struct yep_audio_header {
+    uint32_t magic;
+    uint32_t frequency;         // frames per second
+    uint32_t frame_count;       // samples per channel
+    uint8_t channels;
+    uint8_t format;             // YEP_SAMPLE_FORMAT
+    uint16_t reserved;
+};
+
+struct yep_audio {
+    uint32_t frequency;
+    uint32_t frame_count;
+    uint8_t channels;
+    uint8_t format;
+    const int16_t *samples;     // points into the payload, no copy is made
+};
+
+/**
+ * @brief Parses an audio payload without copying it
+ * 
+ * @param data The payload of a YEP_DATATYPE_PCM entry
+ * @param size The size of the payload
+ * @param out Receives the format and a pointer to the samples
+ * @return true on success, false if the payload is not valid audio
+ */
+bool yep_audio_parse(const void *data, size_t size, struct yep_audio *out);
+
+/*
+    =========================
+    |   ANIMATION PAYLOADS  |
+    =========================
+
+    YEP_DATATYPE_ANIMATION entries are named after their frames with the frame number
+    dropped (sprites/walk_000.png ... -> sprites/walk.anim) and hold a yep_animation_header,
+    a yep_animation_frame table, then each frame payload (itself an image, misc file etc).
+    yep_pack_extract() returns them with every delta frame already resolved.
+*/
+
+#define YEP_ANIMATION_MAGIC 0x494E4159u // "YANI"
+
+#define YEP_ANIMATION_FRAME_DELTA 0x01  // frame bytes are XORed with the previous frame
+
+struct yep_animation_header {
+    uint32_t magic;
+    uint32_t frame_count;
+    uint32_t reserved;
+};
+
+struct yep_animation_frame {
+    uint32_t offset;            // from the start of the payload
+    uint32_t size;
+    uint8_t data_type;          // YEP_DATATYPE of the frame payload
+    uint8_t flags;              // YEP_ANIMATION_FRAME_*
+    uint16_t reserved;
+};
+
+struct yep_animation {
+    uint32_t frame_count;
+    const void *payload;        // no copy is made
+    size_t size;
+};
+
+/**
+ * @brief Parses an animation payload without copying it
+ * 
+ * @param data The payload of a YEP_DATATYPE_ANIMATION entry, with delta frames resolved
+ * @param size The size of the payload
+ * @param out Receives the frame count
+ * @return true on success, false if the payload is not a valid resolved animation
+ */
+bool yep_animation_parse(const void *data, size_t size, struct yep_animation *out);
+
+/**
+ * @brief Gets one frame of a parsed animation
+ * 
+ * @param size Receives the size of the frame payload
+ * @param data_type Receives the YEP_DATATYPE of the frame payload (may be NULL)
+ * @return const void* The frame payload inside the animation (NULL if out of range)
+ */
+const void *yep_animation_frame_data(const struct yep_animation *animation, uint32_t index, size_t *size, uint8_t *data_type);
+
+/**
+ * @brief Undoes delta encoding in place, only needed for payloads not read through yep_pack_extract()
+ */
+bool yep_animation_resolve(void *data, size_t size);
+
 #endif // YEP_H
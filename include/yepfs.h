@@ -16,6 +16,8 @@
 #define YEP_FILESYSTEM_H
 
 #include <time.h>
+#include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #include <SDL3/SDL.h>
@@ -63,10 +65,11 @@ bool yep_delete_file(const char *path);
 bool yep_copy_file(const char *src, const char *dst);
 
 /**
- * @brief Recursively copy a directory.
+ * @brief Recursively copy a directory, files are copied in parallel with yep_copy_range() and keep
+ * their access and modification times (as do the directories).
  * 
  * @param src The source directory
- * @param dst The destination directory
+ * @param dst The destination directory, created if it does not exist
  * @return true on success, false on failure
  */
 bool yep_recurse_copy_dir(const char *src, const char *dst);
@@ -98,6 +101,53 @@ int yep_set_fs_times(const char *path, time_t access_time, time_t modification_t
  */
 bool yep_get_path_info(const char *path, SDL_PathInfo *info);
 
+/**
+ * @brief Remembers the info of every path it stats, so one pack run stats each file at most once.
+ */
+struct yep_stat_cache;
+
+/**
+ * @brief Called for every path yep_stat_cache_walk() visits, parents before their children.
+ */
+typedef void (*yep_stat_callback)(const char *path, const SDL_PathInfo *info, void *userdata);
+
+/**
+ * @brief Create an empty stat cache.
+ *
+ * @return The cache, free it with yep_stat_cache_free
+ */
+struct yep_stat_cache *yep_stat_cache_create(void);
+
+/**
+ * @brief Get the info of a path, statting it only if it is not cached yet.
+ *
+ * @param cache The stat cache
+ * @param path The path to the file or directory
+ * @param info Pointer to SDL_PathInfo structure to fill with information
+ * @return true on success, false on failure
+ */
+bool yep_stat_cache_get(struct yep_stat_cache *cache, const char *path, SDL_PathInfo *info);
+
+/**
+ * @brief Visit everything below a directory. The first walk of a tree lists and stats it in
+ * batches, one directory at a time relative to its open handle (statx on Linux) with the
+ * directories of each level spread over all cores, later walks are answered from the cache.
+ *
+ * @param cache The stat cache
+ * @param root The directory to walk, paths below it are passed as root/relative
+ * @param callback Called for every file and directory below root, may be NULL to only fill the cache
+ * @param userdata Passed to the callback
+ * @return true on success, false if root is not a directory
+ */
+bool yep_stat_cache_walk(struct yep_stat_cache *cache, const char *root, yep_stat_callback callback, void *userdata);
+
+/**
+ * @brief Free a stat cache.
+ *
+ * @param cache The stat cache, may be NULL
+ */
+void yep_stat_cache_free(struct yep_stat_cache *cache);
+
 /**
  * @brief Change the current working directory to the specified path.
  * 
@@ -107,11 +157,50 @@ bool yep_get_path_info(const char *path, SDL_PathInfo *info);
 bool yep_chdir(const char *path);
 
 /**
- * @brief Recursively delete a directory and its contents.
+ * @brief Recursively delete a directory and its contents, independent subtrees are deleted in
+ * parallel. Symbolic links are removed, never followed.
  * 
  * @param path The path to the directory to delete
  * @return true on success, false on failure
  */
 bool yep_recurse_delete_dir(const char *path);
 
+/**
+ * @brief Map a whole file read-only into memory.
+ * 
+ * @param path The path to the file
+ * @param size Receives the size of the mapping in bytes
+ * @return The base of the mapping, or NULL on failure (or if the file is empty)
+ */
+const void *yep_map_file(const char *path, size_t *size);
+
+/**
+ * @brief Release a mapping created by yep_map_file.
+ * 
+ * @param base The base of the mapping
+ * @param size The size of the mapping in bytes
+ */
+void yep_unmap_file(const void *base, size_t size);
+
+/**
+ * @brief Ask the OS to drop its cached pages for a file (best effort, used for cold cache measurements).
+ * 
+ * @param path The path to the file
+ * @return true if the request was issued, false if unsupported or on failure
+ */
+bool yep_drop_file_cache(const char *path);
+
+/**
+ * @brief Copy a byte range from one open file into another without passing it through user space
+ * where possible: shared blocks (reflinks) on btrfs/XFS, copy_file_range on Linux, a buffered copy elsewhere.
+ * 
+ * @param dst The file to write into, flushed first (its stdio position is not kept)
+ * @param dst_offset Where to write in dst
+ * @param src The file to read from
+ * @param src_offset Where to read in src
+ * @param size The number of bytes to copy
+ * @return true on success, false on failure
+ */
+bool yep_copy_range(FILE *dst, uint64_t dst_offset, FILE *src, uint64_t src_offset, uint64_t size);
+
 #endif
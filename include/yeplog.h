@@ -0,0 +1,87 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#ifndef YEP_LOG_H
+#define YEP_LOG_H
+
+#include <stddef.h>     // size_t
+#include <stdbool.h>    // bool type
+
+/*
+    Leveled logger
+
+    yep_logf() is a macro: calls below YEP_LOG_MIN_LEVEL are removed at compile time
+    (their arguments are never evaluated), and calls below the runtime threshold cost
+    a single integer compare. Nothing is formatted unless the message will be emitted.
+*/
+
+enum yep_log_level {
+    yep_log_debug,
+    yep_log_info,
+    yep_log_warning,
+    yep_log_error,
+    yep_log_none,   // threshold only, silences everything
+};
+
+// compile time floor, set through the YEP_LOG_MIN_LEVEL cmake cache variable
+#ifndef YEP_LOG_MIN_LEVEL
+    #define YEP_LOG_MIN_LEVEL 0
+#endif
+
+// runtime threshold, use yep_set_log_level() to change it
+extern enum yep_log_level yep_log_threshold;
+
+#define yep_logf(level, ...)                                                                \
+    do {                                                                                    \
+        if((int)(level) >= YEP_LOG_MIN_LEVEL && (int)(level) >= (int)yep_log_threshold)     \
+            yep_log_write((level), __VA_ARGS__);                                            \
+    } while(0)
+
+/**
+ * @brief Formats and emits a message, bypassing the threshold checks. Prefer yep_logf().
+ */
+void yep_log_write(enum yep_log_level level, const char *fmt, ...);
+
+/**
+ * @brief Sets the runtime log threshold, messages below it are discarded (default: info)
+ */
+void yep_set_log_level(enum yep_log_level level);
+
+/**
+ * @brief Receives every emitted message (already formatted, usually newline terminated)
+ */
+typedef void (*yep_log_sink_fn)(enum yep_log_level level, const char *message, void *userdata);
+
+/**
+ * @brief Routes log output to a user supplied sink
+ * 
+ * @param sink The sink to call, NULL restores the default stdout sink
+ * @param userdata Passed through to the sink
+ */
+void yep_set_log_sink(yep_log_sink_fn sink, void *userdata);
+
+/**
+ * @brief Moves sink calls onto a background thread. Messages are formatted on the calling
+ * thread and queued into a ring buffer, if the buffer is full they are dropped (and counted)
+ * rather than blocking the caller.
+ * 
+ * @param buffer_size The size of the ring buffer in bytes (0 for a sensible default)
+ * @return true on success, false if the worker could not be started
+ */
+bool yep_log_start_async(size_t buffer_size);
+
+/**
+ * @brief Blocks until every queued message has been handed to the sink
+ */
+void yep_log_flush(void);
+
+/**
+ * @brief Flushes and stops the background log thread, returning to synchronous logging
+ */
+void yep_log_stop_async(void);
+
+#endif // YEP_LOG_H
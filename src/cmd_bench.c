@@ -0,0 +1,339 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep bench <pack.yep>
+
+    Replays lookups and extractions over every entry of a real pack, in sequential
+    and seeded random order, on one and many threads, with a cold and a warm page
+    cache. Latency percentiles and throughput are reported per compression type.
+
+    The methodology only depends on the pack and the seed, so results from different
+    libyep versions can be compared directly (the JSON carries a schema version).
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <SDL3/SDL.h>
+
+#include "yepfs.h"
+#include "libyep.h"
+#include "yep_cmd.h"
+#include "yep_internal.h"
+
+#define YEP_CMD_BENCH_SCHEMA_VERSION 1
+
+static uint64_t now_ns(void) {
+    static uint64_t frequency = 0;
+    if(frequency == 0)
+        frequency = SDL_GetPerformanceFrequency();
+
+    return (uint64_t)((double)SDL_GetPerformanceCounter() * 1e9 / (double)frequency);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// expects sorted samples
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p) {
+    if(count == 0)
+        return 0;
+    return sorted[(size_t)(p * (double)(count - 1) + 0.5)];
+}
+
+// seeded fisher-yates so random order is identical across runs and versions
+static void shuffle(uint32_t *order, uint32_t count, uint64_t seed) {
+    uint64_t state = seed;
+    for(uint32_t i = count; i > 1; i--) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+
+        uint32_t j = (uint32_t)(z % i);
+        uint32_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+}
+
+/*
+    ================================ SCENARIO RUNNER ================================
+*/
+
+struct bench_run {
+    struct yep_pack *pack;
+    const uint32_t *order;      // entry indices in replay order
+    uint32_t count;
+    bool extract;               // false: lookups only
+
+    uint64_t *latency;          // per position in order
+    uint64_t *bytes;            // per position in order
+
+    SDL_AtomicInt cursor;
+};
+
+static int SDLCALL bench_worker(void *userdata) {
+    struct bench_run *run = userdata;
+
+    while(true) {
+        int position = SDL_AddAtomicInt(&run->cursor, 1);
+        if(position >= (int)run->count)
+            break;
+
+        uint32_t index = run->order[position];
+
+        if(run->extract) {
+            uint64_t start = now_ns();
+            struct yep_data_info data = yep_pack_extract(run->pack, index);
+            run->latency[position] = now_ns() - start;
+            run->bytes[position] = data.size;
+            free(data.data);
+        } else {
+            const char *name = yep_pack_entry(run->pack, index)->name;
+            uint64_t start = now_ns();
+            int32_t found = yep_pack_find(run->pack, name);
+            run->latency[position] = now_ns() - start;
+            run->bytes[position] = found >= 0 ? 1 : 0;
+        }
+    }
+
+    return 0;
+}
+
+// returns the wall time of the run in ns
+static uint64_t bench_replay(struct bench_run *run, int threads) {
+    SDL_SetAtomicInt(&run->cursor, 0);
+
+    uint64_t start = now_ns();
+    if(threads <= 1) {
+        bench_worker(run);
+    } else {
+        SDL_Thread **workers = calloc((size_t)threads, sizeof(SDL_Thread *));
+        for(int i = 0; i < threads; i++)
+            workers[i] = SDL_CreateThread(bench_worker, "yep_bench", run);
+        for(int i = 0; i < threads; i++) {
+            // fall back to running on this thread if one could not be created
+            if(workers[i] == NULL)
+                bench_worker(run);
+            else
+                SDL_WaitThread(workers[i], NULL);
+        }
+        free(workers);
+    }
+    return now_ns() - start;
+}
+
+/*
+    ==================================== REPORTING ===================================
+*/
+
+struct bench_report {
+    bool json;
+    bool first;
+};
+
+static void report_row(struct bench_report *report, const char *benchmark, const char *order, int threads, const char *cache,
+                       const char *codec, uint64_t entries, uint64_t bytes, uint64_t p50, uint64_t p99, uint64_t busy_ns, uint64_t wall_ns) {
+    double gib = bytes / (1024.0 * 1024.0 * 1024.0);
+
+    if(report->json) {
+        printf("%s\n    {\"benchmark\": \"%s\", \"order\": \"%s\", \"threads\": %d, \"cache\": \"%s\", \"codec\": \"%s\", "
+               "\"entries\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", "
+               "\"busy_ns\": %" PRIu64 ", \"wall_ns\": %" PRIu64 ", \"gib_per_s\": %.6f}",
+               report->first ? "" : ",", benchmark, order, threads, cache, codec, entries, bytes, p50, p99,
+               busy_ns, wall_ns, wall_ns ? gib / (wall_ns / 1e9) : 0.0);
+        report->first = false;
+        return;
+    }
+
+    printf("%-8s %-6s %3d %-5s %-8s %8" PRIu64 " %12.2f %12.2f",
+           benchmark, order, threads, cache, codec, entries, p50 / 1000.0, p99 / 1000.0);
+    if(bytes > 0 && wall_ns > 0)
+        printf(" %10.3f", gib / (wall_ns / 1e9));
+    printf("\n");
+}
+
+/*
+    Reports one replay: every codec on its own, then all of them together. Per codec
+    throughput uses that codec's share of the wall time (busy time ratio).
+*/
+static void report_run(struct bench_report *report, struct bench_run *run, const char *benchmark, const char *order,
+                       int threads, const char *cache, uint64_t wall_ns) {
+    uint64_t *samples = malloc((run->count ? run->count : 1) * sizeof(uint64_t));
+
+    uint64_t total_busy = 0;
+    for(uint32_t i = 0; i < run->count; i++)
+        total_busy += run->latency[i];
+
+    bool seen[256] = {false};
+    for(uint32_t i = 0; i < run->count; i++)
+        seen[yep_pack_entry(run->pack, run->order[i])->compression_type] = true;
+
+    for(int codec = 0; codec < 256 && run->extract; codec++) {
+        if(!seen[codec])
+            continue;
+
+        size_t count = 0;
+        uint64_t bytes = 0, busy = 0;
+        for(uint32_t i = 0; i < run->count; i++) {
+            if(yep_pack_entry(run->pack, run->order[i])->compression_type != codec)
+                continue;
+            samples[count++] = run->latency[i];
+            bytes += run->bytes[i];
+            busy += run->latency[i];
+        }
+
+        qsort(samples, count, sizeof(uint64_t), compare_u64);
+        uint64_t share = total_busy ? (uint64_t)((double)wall_ns * busy / total_busy) : wall_ns;
+        report_row(report, benchmark, order, threads, cache, yep_compression_name((uint8_t)codec), count, bytes,
+                   percentile(samples, count, 0.50), percentile(samples, count, 0.99), busy, share);
+    }
+
+    uint64_t bytes = 0;
+    for(uint32_t i = 0; i < run->count; i++) {
+        samples[i] = run->latency[i];
+        bytes += run->extract ? run->bytes[i] : 0;
+    }
+    qsort(samples, run->count, sizeof(uint64_t), compare_u64);
+    report_row(report, benchmark, order, threads, cache, "all", run->count, bytes,
+               percentile(samples, run->count, 0.50), percentile(samples, run->count, 0.99), total_busy, wall_ns);
+
+    free(samples);
+}
+
+/*
+    ====================================== ENTRY ======================================
+*/
+
+static void bench_usage(void) {
+    printf("Usage: yep bench [options] <pack.yep>\n");
+    printf("Measure lookup and extraction performance of an existing pack\n\n");
+    printf("Options:\n");
+    printf("  --threads <n>     Threads for the multi threaded runs (default: logical cores)\n");
+    printf("  --seed <n>        Seed for the random replay order (default: 1)\n");
+    printf("  --json            Print machine readable JSON instead of a table\n");
+}
+
+int yep_cmd_bench(int argc, char **argv) {
+    const char *pack_path = NULL;
+    int threads = SDL_GetNumLogicalCPUCores();
+    uint64_t seed = 1;
+    bool json = false;
+
+    for(int i = 0; i < argc; i++) {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if(strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if(argv[i][0] != '-' && pack_path == NULL)
+            pack_path = argv[i];
+        else {
+            bench_usage();
+            return 1;
+        }
+    }
+
+    if(pack_path == NULL) {
+        bench_usage();
+        return 1;
+    }
+    if(threads < 1)
+        threads = 1;
+
+    struct yep_pack *pack = yep_pack_open(pack_path);
+    if(pack == NULL)
+        return 1;
+
+    uint32_t count = yep_pack_entry_count(pack);
+
+    uint32_t *sequential = malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t *random = malloc((count ? count : 1) * sizeof(uint32_t));
+    for(uint32_t i = 0; i < count; i++)
+        sequential[i] = random[i] = i;
+    shuffle(random, count, seed);
+
+    struct bench_run run = {
+        .pack = pack,
+        .count = count,
+        .latency = calloc(count ? count : 1, sizeof(uint64_t)),
+        .bytes = calloc(count ? count : 1, sizeof(uint64_t)),
+    };
+
+    struct bench_report report = { .json = json, .first = true };
+    int result = 0;
+
+    SDL_PathInfo info;
+    uint64_t pack_bytes = SDL_GetPathInfo(pack_path, &info) ? info.size : 0;
+
+    if(json) {
+        printf("{\n  \"schema\": %d,\n  \"format_version\": %d,\n  \"pack\": ",
+               YEP_CMD_BENCH_SCHEMA_VERSION, yep_pack_version(pack));
+        yep_write_json_string(stdout, pack_path);
+        printf(",\n  \"pack_bytes\": %" PRIu64 ",\n  \"entries\": %u,\n  \"seed\": %" PRIu64 ",\n  \"results\": [",
+               pack_bytes, count, seed);
+    } else {
+        printf("%s: %u entries, %.1f MiB\n\n", pack_path, count, pack_bytes / (1024.0 * 1024.0));
+        printf("%-8s %-6s %3s %-5s %-8s %8s %12s %12s %10s\n",
+               "bench", "order", "thr", "cache", "codec", "entries", "p50 us", "p99 us", "GiB/s");
+    }
+
+    const char *orders[2] = { "seq", "random" };
+    const uint32_t *order_tables[2] = { sequential, random };
+
+    // lookups are a pure index operation, the page cache does not matter
+    run.extract = false;
+    for(int o = 0; o < 2; o++) {
+        run.order = order_tables[o];
+        uint64_t wall = bench_replay(&run, 1);
+        report_run(&report, &run, "lookup", orders[o], 1, "warm", wall);
+    }
+
+    run.extract = true;
+    int thread_counts[2] = { 1, threads };
+    for(int t = 0; t < (threads > 1 ? 2 : 1); t++) {
+        for(int o = 0; o < 2; o++) {
+            run.order = order_tables[o];
+
+            // cold: drop the page cache and remap before replaying
+            yep_pack_close(pack);
+            bool dropped = yep_drop_file_cache(pack_path);
+            pack = run.pack = yep_pack_open(pack_path);
+            if(pack == NULL) {
+                result = 1;
+                goto cleanup;
+            }
+
+            uint64_t wall = bench_replay(&run, thread_counts[t]);
+            report_run(&report, &run, "extract", orders[o], thread_counts[t], dropped ? "cold" : "nodrop", wall);
+
+            // warm: the previous replay touched every page
+            wall = bench_replay(&run, thread_counts[t]);
+            report_run(&report, &run, "extract", orders[o], thread_counts[t], "warm", wall);
+        }
+    }
+
+    if(json)
+        printf("\n  ]\n}\n");
+
+cleanup:
+    free(run.latency);
+    free(run.bytes);
+    free(sequential);
+    free(random);
+    yep_pack_close(pack);
+
+    return result;
+}
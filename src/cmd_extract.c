@@ -0,0 +1,245 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep extract [--jobs n] [-o dir] <pack.yep> [pattern...]
+
+    Unpacks entries to disk. The output directory tree is created up front, then
+    worker threads pull entries off a shared cursor, decompress them straight out
+    of the mapped pack and write them out independently.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <SDL3/SDL.h>
+
+#include "libyep.h"
+#include "yep_cmd.h"
+
+struct extract_job {
+    struct yep_pack *pack;
+    const char *output_dir;
+
+    uint32_t *selected;     // entry indices to extract
+    uint32_t count;
+
+    SDL_AtomicInt cursor;
+    SDL_AtomicInt failures;
+};
+
+// rejects names that would escape the output directory
+static bool safe_entry_name(const char *name) {
+    if(name[0] == '/' || name[0] == '\0' || strchr(name, ':') != NULL)
+        return false;
+
+    for(const char *part = name; part != NULL; part = strchr(part, '/')) {
+        if(*part == '/')
+            part++;
+        if(strncmp(part, "..", 2) == 0 && (part[2] == '/' || part[2] == '\0'))
+            return false;
+    }
+    return true;
+}
+
+static bool write_entry(struct extract_job *job, uint32_t index) {
+    const struct yep_entry *entry = yep_pack_entry(job->pack, index);
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", job->output_dir, entry->name);
+
+    struct yep_data_info data = yep_pack_extract(job->pack, index);
+    if(data.data == NULL && entry->uncompressed_size > 0) {
+        yep_logf(yep_log_error, "Failed to extract %s\n", entry->name);
+        return false;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if(file == NULL) {
+        yep_logf(yep_log_error, "Failed to open %s for writing\n", path);
+        free(data.data);
+        return false;
+    }
+
+    bool ok = fwrite(data.data, 1, data.size, file) == data.size;
+    ok = (fclose(file) == 0) && ok;
+    free(data.data);
+
+    if(!ok)
+        yep_logf(yep_log_error, "Failed to write %s\n", path);
+    else
+        yep_logf(yep_log_debug, "Extracted %s\n", path);
+
+    return ok;
+}
+
+static int SDLCALL extract_worker(void *userdata) {
+    struct extract_job *job = userdata;
+
+    while(true) {
+        int position = SDL_AddAtomicInt(&job->cursor, 1);
+        if(position >= (int)job->count)
+            break;
+
+        if(!write_entry(job, job->selected[position]))
+            SDL_AddAtomicInt(&job->failures, 1);
+    }
+
+    return 0;
+}
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// creates every parent directory of the selection once, before any worker starts
+static bool create_directories(struct extract_job *job) {
+    char **parents = malloc((job->count ? job->count : 1) * sizeof(char *));
+    uint32_t parent_count = 0;
+
+    for(uint32_t i = 0; i < job->count; i++) {
+        const char *name = yep_pack_entry(job->pack, job->selected[i])->name;
+        const char *slash = strrchr(name, '/');
+        if(slash == NULL)
+            continue;
+
+        size_t len = (size_t)(slash - name);
+        char *parent = malloc(len + 1);
+        memcpy(parent, name, len);
+        parent[len] = '\0';
+        parents[parent_count++] = parent;
+    }
+
+    qsort(parents, parent_count, sizeof(char *), compare_strings);
+
+    // SDL_CreateDirectory also creates missing parents and succeeds if the directory exists
+    bool ok = SDL_CreateDirectory(job->output_dir);
+    for(uint32_t i = 0; i < parent_count; i++) {
+        if(ok && (i == 0 || strcmp(parents[i], parents[i - 1]) != 0)) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%s", job->output_dir, parents[i]);
+            ok = SDL_CreateDirectory(path);
+            if(!ok)
+                yep_logf(yep_log_error, "Failed to create directory: %s. %s\n", path, SDL_GetError());
+        }
+        free(parents[i]);
+    }
+
+    free(parents);
+    return ok;
+}
+
+static void extract_usage(void) {
+    printf("Usage: yep extract [options] <pack.yep> [pattern...]\n");
+    printf("Extract entries (all by default) selected by exact name, dir/ prefix or glob\n\n");
+    printf("Options:\n");
+    printf("  -o, --output <dir>  Output directory (default: current directory)\n");
+    printf("  -j, --jobs <n>      Parallel workers (default: logical cores)\n");
+}
+
+int yep_cmd_extract(int argc, char **argv) {
+    const char *output_dir = ".";
+    int jobs = SDL_GetNumLogicalCPUCores();
+    const char *pack_path = NULL;
+    char **patterns = calloc((size_t)argc + 1, sizeof(char *));
+    int pattern_count = 0;
+
+    for(int i = 0; i < argc; i++) {
+        if((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i + 1 < argc)
+            output_dir = argv[++i];
+        else if((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if(argv[i][0] == '-') {
+            extract_usage();
+            free(patterns);
+            return 1;
+        }
+        else if(pack_path == NULL)
+            pack_path = argv[i];
+        else
+            patterns[pattern_count++] = argv[i];
+    }
+
+    if(pack_path == NULL) {
+        extract_usage();
+        free(patterns);
+        return 1;
+    }
+    if(jobs < 1)
+        jobs = 1;
+
+    struct yep_pack *pack = yep_pack_open(pack_path);
+    if(pack == NULL) {
+        free(patterns);
+        return 1;
+    }
+
+    struct extract_job job = {
+        .pack = pack,
+        .output_dir = output_dir,
+        .selected = malloc((yep_pack_entry_count(pack) + 1) * sizeof(uint32_t)),
+        .count = 0,
+    };
+
+    uint64_t total_bytes = 0;
+    for(uint32_t i = 0; i < yep_pack_entry_count(pack); i++) {
+        const struct yep_entry *entry = yep_pack_entry(pack, i);
+        if(!yep_cmd_match(entry->name, pattern_count, patterns))
+            continue;
+
+        if(!safe_entry_name(entry->name)) {
+            yep_logf(yep_log_warning, "Skipping unsafe entry name: %s\n", entry->name);
+            continue;
+        }
+
+        job.selected[job.count++] = i;
+        total_bytes += entry->uncompressed_size;
+    }
+
+    int status = 0;
+    if(!create_directories(&job)) {
+        status = 1;
+        goto cleanup;
+    }
+
+    Uint64 start = SDL_GetTicksNS();
+
+    if(jobs == 1 || job.count < 2) {
+        extract_worker(&job);
+    } else {
+        SDL_Thread **workers = calloc((size_t)jobs, sizeof(SDL_Thread *));
+        for(int i = 0; i < jobs; i++)
+            workers[i] = SDL_CreateThread(extract_worker, "yep_extract", &job);
+        for(int i = 0; i < jobs; i++) {
+            if(workers[i] == NULL)
+                extract_worker(&job);
+            else
+                SDL_WaitThread(workers[i], NULL);
+        }
+        free(workers);
+    }
+
+    double seconds = (SDL_GetTicksNS() - start) / 1e9;
+    int failures = SDL_GetAtomicInt(&job.failures);
+
+    yep_logf(yep_log_info, "Extracted %u entries (%.1f MiB) to %s in %.3fs (%.1f MiB/s)\n",
+        job.count - (uint32_t)failures, total_bytes / (1024.0 * 1024.0), output_dir, seconds,
+        seconds > 0 ? total_bytes / (1024.0 * 1024.0) / seconds : 0.0);
+
+    if(failures > 0) {
+        yep_logf(yep_log_error, "%d entries failed to extract\n", failures);
+        status = 1;
+    }
+
+cleanup:
+    free(job.selected);
+    free(patterns);
+    yep_pack_close(pack);
+    return status;
+}
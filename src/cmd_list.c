@@ -0,0 +1,195 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep list <pack.yep> [pattern...]
+    yep info <pack.yep>
+
+    Read-only inspection of a pack, neither command decompresses anything.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "libyep.h"
+#include "yep_cmd.h"
+
+bool yep_cmd_match(const char *name, int pattern_count, char **patterns) {
+    if(pattern_count == 0)
+        return true;
+
+    for(int i = 0; i < pattern_count; i++) {
+        const char *pattern = patterns[i];
+        size_t len = strlen(pattern);
+
+        if(strpbrk(pattern, "*?") != NULL) {
+            if(yep_cmd_glob(pattern, name))
+                return true;
+        }
+        // a trailing slash selects everything below that directory
+        else if(len > 0 && pattern[len - 1] == '/') {
+            if(strncmp(name, pattern, len) == 0)
+                return true;
+        }
+        else if(strcmp(name, pattern) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool yep_cmd_glob(const char *pattern, const char *name) {
+    // iterative glob with single star backtracking, '*' also matches '/'
+    const char *star = NULL;
+    const char *resume = NULL;
+
+    while(*name) {
+        if(*pattern == '?' || *pattern == *name) {
+            pattern++;
+            name++;
+        }
+        else if(*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        }
+        else if(star != NULL) {
+            pattern = star + 1;
+            name = ++resume;
+        }
+        else {
+            return false;
+        }
+    }
+
+    while(*pattern == '*')
+        pattern++;
+
+    return *pattern == '\0';
+}
+
+static double ratio(uint32_t stored, uint32_t raw) {
+    return raw ? (double)stored / (double)raw : 1.0;
+}
+
+int yep_cmd_list(int argc, char **argv) {
+    if(argc < 1) {
+        printf("Usage: yep list <pack.yep> [pattern...]\n");
+        printf("List the entries of a pack, optionally filtered by exact name, dir/ prefix or glob\n");
+        return 1;
+    }
+
+    struct yep_pack *pack = yep_pack_open(argv[0]);
+    if(pack == NULL)
+        return 1;
+
+    printf("%12s %12s %7s %-6s %-12s %s\n", "stored", "raw", "ratio", "codec", "type", "name");
+
+    uint32_t shown = 0;
+    uint64_t stored_total = 0, raw_total = 0;
+    for(uint32_t i = 0; i < yep_pack_entry_count(pack); i++) {
+        const struct yep_entry *entry = yep_pack_entry(pack, i);
+        if(!yep_cmd_match(entry->name, argc - 1, argv + 1))
+            continue;
+
+        printf("%12" PRIu32 " %12" PRIu32 " %6.1f%% %-6s %-12s %s\n",
+            entry->size, entry->uncompressed_size, ratio(entry->size, entry->uncompressed_size) * 100.0,
+            yep_compression_name(entry->compression_type), yep_datatype_name(entry->data_type), entry->name);
+
+        shown++;
+        stored_total += entry->size;
+        raw_total += entry->uncompressed_size;
+    }
+
+    printf("%12" PRIu64 " %12" PRIu64 " %6.1f%% %u entries\n",
+        stored_total, raw_total, raw_total ? 100.0 * stored_total / raw_total : 100.0, shown);
+
+    yep_pack_close(pack);
+    return 0;
+}
+
+int yep_cmd_info(int argc, char **argv) {
+    if(argc != 1) {
+        printf("Usage: yep info <pack.yep>\n");
+        printf("Print statistics about a pack\n");
+        return 1;
+    }
+
+    struct yep_pack *pack = yep_pack_open(argv[0]);
+    if(pack == NULL)
+        return 1;
+
+    uint32_t count = yep_pack_entry_count(pack);
+
+    struct {
+        uint32_t entries;
+        uint64_t stored;
+        uint64_t raw;
+    } by_codec[256] = {0}, by_type[256] = {0}, total = {0};
+
+    const struct yep_entry *largest = NULL;
+    const struct yep_entry *worst = NULL;   // worst ratio among compressed entries
+
+    for(uint32_t i = 0; i < count; i++) {
+        const struct yep_entry *entry = yep_pack_entry(pack, i);
+
+        by_codec[entry->compression_type].entries++;
+        by_codec[entry->compression_type].stored += entry->size;
+        by_codec[entry->compression_type].raw += entry->uncompressed_size;
+
+        by_type[entry->data_type].entries++;
+        by_type[entry->data_type].stored += entry->size;
+        by_type[entry->data_type].raw += entry->uncompressed_size;
+
+        total.entries++;
+        total.stored += entry->size;
+        total.raw += entry->uncompressed_size;
+
+        if(largest == NULL || entry->uncompressed_size > largest->uncompressed_size)
+            largest = entry;
+        if(entry->compression_type != YEP_COMPRESSION_NONE &&
+           (worst == NULL || ratio(entry->size, entry->uncompressed_size) > ratio(worst->size, worst->uncompressed_size)))
+            worst = entry;
+    }
+
+    uint64_t header_bytes = 3 + (uint64_t)count * YEP_HEADER_SIZE_BYTES;
+
+    printf("pack:            %s\n", yep_pack_path(pack));
+    printf("format version:  %u\n", yep_pack_version(pack));
+    printf("entries:         %u\n", count);
+    printf("header bytes:    %" PRIu64 "\n", header_bytes);
+    printf("stored bytes:    %" PRIu64 "\n", total.stored);
+    printf("raw bytes:       %" PRIu64 "\n", total.raw);
+    printf("overall ratio:   %.1f%%\n", total.raw ? 100.0 * total.stored / total.raw : 100.0);
+    if(largest != NULL)
+        printf("largest entry:   %s (%" PRIu32 " bytes)\n", largest->name, largest->uncompressed_size);
+    if(worst != NULL)
+        printf("worst ratio:     %s (%.1f%%)\n", worst->name, ratio(worst->size, worst->uncompressed_size) * 100.0);
+
+    printf("\n%-12s %8s %14s %14s %7s\n", "codec", "entries", "stored", "raw", "ratio");
+    for(int i = 0; i < 256; i++) {
+        if(by_codec[i].entries == 0)
+            continue;
+        printf("%-12s %8u %14" PRIu64 " %14" PRIu64 " %6.1f%%\n", yep_compression_name((uint8_t)i),
+            by_codec[i].entries, by_codec[i].stored, by_codec[i].raw,
+            by_codec[i].raw ? 100.0 * by_codec[i].stored / by_codec[i].raw : 100.0);
+    }
+
+    printf("\n%-12s %8s %14s %14s %7s\n", "type", "entries", "stored", "raw", "ratio");
+    for(int i = 0; i < 256; i++) {
+        if(by_type[i].entries == 0)
+            continue;
+        printf("%-12s %8u %14" PRIu64 " %14" PRIu64 " %6.1f%%\n", yep_datatype_name((uint8_t)i),
+            by_type[i].entries, by_type[i].stored, by_type[i].raw,
+            by_type[i].raw ? 100.0 * by_type[i].stored / by_type[i].raw : 100.0);
+    }
+
+    yep_pack_close(pack);
+    return 0;
+}
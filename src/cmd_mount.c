@@ -0,0 +1,426 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep mount [--cache-limit <MB>] <pack.yep> <mountpoint> [fuse options...]
+
+    Mounts a pack read-only through FUSE (built with YEP_FUSE_SUPPORT), every entry shows
+    up as a file under its name. Nothing is extracted up front: uncompressed entries are
+    read straight out of the mapping, compressed ones are decoded the first time they are
+    read and kept in a least recently used cache of decoded entries, up to the cache limit.
+    Requests are handled on multiple threads (pass -s to use one).
+
+    Entries are single compressed streams, so the cache holds whole entries rather than
+    blocks. Unmount with fusermount3 -u <mountpoint> or ctrl+c when running with -f.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "libyep.h"
+#include "yep_cmd.h"
+
+#ifdef YEP_HAVE_FUSE
+
+#define FUSE_USE_VERSION 31
+#include <fuse.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <SDL3/SDL.h>
+
+#define MOUNT_DEFAULT_CACHE_MB 256
+
+// implicit directory made of the entry names, children index back into the pack and this table
+struct mount_dir {
+    char *path;                 // "" for the root, no trailing slash
+    uint32_t *files;
+    uint32_t file_count;
+    uint32_t *dirs;
+    uint32_t dir_count;
+};
+
+struct mount_cached {
+    char *data;
+    size_t size;
+    uint64_t last_used;
+    uint32_t readers;           // not evicted while a read copies out of it
+};
+
+struct mount_state {
+    struct yep_pack *pack;
+    SDL_Time modify_time;
+
+    struct mount_dir *dirs;     // sorted by path
+    uint32_t dir_count;
+
+    SDL_Mutex *lock;            // guards everything below
+    struct mount_cached **cached;   // by entry index
+    uint64_t cache_limit;
+    uint64_t cache_used;
+    uint64_t clock;
+};
+
+static struct mount_state mount;
+
+static int compare_dirs(const void *a, const void *b) {
+    return strcmp(((const struct mount_dir *)a)->path, ((const struct mount_dir *)b)->path);
+}
+
+static int32_t find_dir(const char *path) {
+    struct mount_dir key = { .path = (char *)path };
+    const struct mount_dir *dir = bsearch(&key, mount.dirs, mount.dir_count, sizeof(struct mount_dir), compare_dirs);
+    return dir != NULL ? (int32_t)(dir - mount.dirs) : -1;
+}
+
+static void append(uint32_t **list, uint32_t *count, uint32_t value) {
+    // grows in powers of two
+    if((*count & (*count - 1)) == 0)
+        *list = realloc(*list, (*count ? *count * 2 : 1) * sizeof(uint32_t));
+    (*list)[(*count)++] = value;
+}
+
+// the directory part of a path ("a/b/c" -> "a/b", "c" -> "")
+static void parent_of(const char *path, char *out, size_t out_size) {
+    const char *slash = strrchr(path, '/');
+    size_t length = slash != NULL ? (size_t)(slash - path) : 0;
+    snprintf(out, out_size, "%.*s", (int)length, path);
+}
+
+static void build_tree(void) {
+    uint32_t count = yep_pack_entry_count(mount.pack);
+
+    // every prefix of every name that ends at a slash, plus the root
+    uint32_t capacity = 16;
+    mount.dirs = malloc(capacity * sizeof(struct mount_dir));
+    mount.dirs[0] = (struct mount_dir){ .path = strdup("") };
+    mount.dir_count = 1;
+
+    for(uint32_t i = 0; i < count; i++) {
+        const char *name = yep_pack_entry(mount.pack, i)->name;
+        for(const char *slash = strchr(name, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+            if(mount.dir_count == capacity) {
+                capacity *= 2;
+                mount.dirs = realloc(mount.dirs, capacity * sizeof(struct mount_dir));
+            }
+            mount.dirs[mount.dir_count++] = (struct mount_dir){ .path = strndup(name, (size_t)(slash - name)) };
+        }
+    }
+
+    qsort(mount.dirs, mount.dir_count, sizeof(struct mount_dir), compare_dirs);
+
+    uint32_t unique = 0;
+    for(uint32_t i = 0; i < mount.dir_count; i++) {
+        if(unique > 0 && strcmp(mount.dirs[unique - 1].path, mount.dirs[i].path) == 0)
+            free(mount.dirs[i].path);
+        else
+            mount.dirs[unique++] = mount.dirs[i];
+    }
+    mount.dir_count = unique;
+
+    char parent[64];
+    for(uint32_t i = 0; i < count; i++) {
+        parent_of(yep_pack_entry(mount.pack, i)->name, parent, sizeof(parent));
+        struct mount_dir *dir = &mount.dirs[find_dir(parent)];
+        append(&dir->files, &dir->file_count, i);
+    }
+    for(uint32_t i = 1; i < mount.dir_count; i++) {
+        parent_of(mount.dirs[i].path, parent, sizeof(parent));
+        struct mount_dir *dir = &mount.dirs[find_dir(parent)];
+        append(&dir->dirs, &dir->dir_count, i);
+    }
+}
+
+static void free_tree(void) {
+    for(uint32_t i = 0; i < mount.dir_count; i++) {
+        free(mount.dirs[i].path);
+        free(mount.dirs[i].files);
+        free(mount.dirs[i].dirs);
+    }
+    free(mount.dirs);
+}
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash != NULL ? slash + 1 : path;
+}
+
+// entries that can be read out of the mapping as is, animations need their delta frames resolved
+static bool is_direct(const struct yep_entry *entry) {
+    return entry->compression_type == YEP_COMPRESSION_NONE && entry->data_type != YEP_DATATYPE_ANIMATION;
+}
+
+/*
+    Decoded entry cache
+*/
+
+// drops least recently used entries nobody is reading until size more bytes fit, lock held
+static void make_room(size_t size) {
+    uint32_t count = yep_pack_entry_count(mount.pack);
+
+    while(mount.cache_used + size > mount.cache_limit) {
+        int64_t oldest = -1;
+        for(uint32_t i = 0; i < count; i++) {
+            struct mount_cached *cached = mount.cached[i];
+            if(cached != NULL && cached->readers == 0 && (oldest < 0 || cached->last_used < mount.cached[oldest]->last_used))
+                oldest = i;
+        }
+        if(oldest < 0)
+            return;
+
+        mount.cache_used -= mount.cached[oldest]->size;
+        free(mount.cached[oldest]->data);
+        free(mount.cached[oldest]);
+        mount.cached[oldest] = NULL;
+    }
+}
+
+// the decoded entry with a reader held, NULL if it cannot be decoded
+static struct mount_cached *acquire(uint32_t index) {
+    SDL_LockMutex(mount.lock);
+    struct mount_cached *cached = mount.cached[index];
+    if(cached != NULL) {
+        cached->readers++;
+        cached->last_used = ++mount.clock;
+        SDL_UnlockMutex(mount.lock);
+        return cached;
+    }
+    SDL_UnlockMutex(mount.lock);
+
+    // decoded without the lock, two threads racing on the same entry just decode it twice
+    struct yep_data_info info = yep_pack_extract(mount.pack, index);
+    if(info.data == NULL)
+        return NULL;
+
+    SDL_LockMutex(mount.lock);
+    cached = mount.cached[index];
+    if(cached != NULL) {
+        free(info.data);
+    }
+    else {
+        make_room(info.size);
+
+        cached = malloc(sizeof(struct mount_cached));
+        cached->data = info.data;
+        cached->size = info.size;
+        cached->readers = 0;
+        mount.cached[index] = cached;
+        mount.cache_used += info.size;
+    }
+    cached->readers++;
+    cached->last_used = ++mount.clock;
+    SDL_UnlockMutex(mount.lock);
+    return cached;
+}
+
+static void release(uint32_t index, struct mount_cached *cached) {
+    SDL_LockMutex(mount.lock);
+    cached->readers--;
+
+    // an entry larger than the whole cache is only kept while it is being read
+    if(cached->readers == 0 && mount.cache_used > mount.cache_limit) {
+        mount.cache_used -= cached->size;
+        free(cached->data);
+        free(cached);
+        mount.cached[index] = NULL;
+    }
+    SDL_UnlockMutex(mount.lock);
+}
+
+/*
+    FUSE operations, paths always start with '/'
+*/
+
+static void fill_stat(struct stat *st, mode_t mode, off_t size) {
+    memset(st, 0, sizeof(*st));
+    st->st_mode = mode;
+    st->st_nlink = S_ISDIR(mode) ? 2 : 1;
+    st->st_size = size;
+    st->st_uid = getuid();
+    st->st_gid = getgid();
+
+    // everything in the pack is as old as the pack
+    st->st_mtime = (time_t)SDL_NS_TO_SECONDS(mount.modify_time);
+    st->st_ctime = st->st_mtime;
+    st->st_atime = st->st_mtime;
+}
+
+static int mount_getattr(const char *path, struct stat *st, struct fuse_file_info *fi) {
+    (void)fi;
+
+    int32_t index = yep_pack_find(mount.pack, path + 1);
+    if(index >= 0) {
+        fill_stat(st, S_IFREG | 0444, (off_t)yep_pack_entry(mount.pack, (uint32_t)index)->uncompressed_size);
+        return 0;
+    }
+
+    if(find_dir(path + 1) >= 0) {
+        fill_stat(st, S_IFDIR | 0555, 0);
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+static int mount_readdir(const char *path, void *buffer, fuse_fill_dir_t filler, off_t offset,
+                         struct fuse_file_info *fi, enum fuse_readdir_flags flags) {
+    (void)offset; (void)fi; (void)flags;
+
+    int32_t found = find_dir(path + 1);
+    if(found < 0)
+        return -ENOENT;
+    const struct mount_dir *dir = &mount.dirs[found];
+
+    filler(buffer, ".", NULL, 0, 0);
+    filler(buffer, "..", NULL, 0, 0);
+    for(uint32_t i = 0; i < dir->dir_count; i++)
+        filler(buffer, base_name(mount.dirs[dir->dirs[i]].path), NULL, 0, 0);
+    for(uint32_t i = 0; i < dir->file_count; i++)
+        filler(buffer, base_name(yep_pack_entry(mount.pack, dir->files[i])->name), NULL, 0, 0);
+
+    return 0;
+}
+
+static int mount_open(const char *path, struct fuse_file_info *fi) {
+    int32_t index = yep_pack_find(mount.pack, path + 1);
+    if(index < 0)
+        return -ENOENT;
+    if((fi->flags & O_ACCMODE) != O_RDONLY)
+        return -EROFS;
+
+    // the pack cannot change under the mount, let the kernel keep what it read
+    fi->fh = (uint64_t)index;
+    fi->keep_cache = 1;
+    return 0;
+}
+
+static int mount_read(const char *path, char *buffer, size_t size, off_t offset, struct fuse_file_info *fi) {
+    (void)path;
+
+    uint32_t index = (uint32_t)fi->fh;
+    const struct yep_entry *entry = yep_pack_entry(mount.pack, index);
+
+    if(is_direct(entry)) {
+        size_t length;
+        const char *data = yep_pack_view(mount.pack, index, &length);
+        if(data == NULL)
+            return -EIO;
+        if((uint64_t)offset >= length)
+            return 0;
+
+        size_t count = SDL_min(size, length - (size_t)offset);
+        memcpy(buffer, data + offset, count);
+        return (int)count;
+    }
+
+    struct mount_cached *cached = acquire(index);
+    if(cached == NULL)
+        return -EIO;
+
+    size_t count = 0;
+    if((uint64_t)offset < cached->size) {
+        count = SDL_min(size, cached->size - (size_t)offset);
+        memcpy(buffer, cached->data + offset, count);
+    }
+
+    release(index, cached);
+    return (int)count;
+}
+
+static void *mount_init(struct fuse_conn_info *connection, struct fuse_config *config) {
+    (void)connection;
+
+    // nothing changes while mounted, cache attributes and contents for as long as the kernel likes
+    config->kernel_cache = 1;
+    config->entry_timeout = 3600.0;
+    config->attr_timeout = 3600.0;
+    config->negative_timeout = 3600.0;
+    return NULL;
+}
+
+static const struct fuse_operations mount_operations = {
+    .init = mount_init,
+    .getattr = mount_getattr,
+    .readdir = mount_readdir,
+    .open = mount_open,
+    .read = mount_read,
+};
+
+int yep_cmd_mount(int argc, char **argv) {
+    mount.cache_limit = (uint64_t)MOUNT_DEFAULT_CACHE_MB << 20;
+
+    int first = 0;
+    if(argc >= 2 && strcmp(argv[0], "--cache-limit") == 0) {
+        mount.cache_limit = strtoull(argv[1], NULL, 10) << 20;
+        first = 2;
+    }
+
+    if(argc - first < 2) {
+        fprintf(stderr, "Usage: yep mount [--cache-limit <MB>] <pack.yep> <mountpoint> [fuse options...]\n");
+        return 1;
+    }
+    const char *pack_file = argv[first];
+
+    yep_initialize();
+
+    mount.pack = yep_pack_open(pack_file);
+    if(mount.pack == NULL) {
+        yep_shutdown();
+        return 1;
+    }
+
+    SDL_PathInfo info;
+    mount.modify_time = SDL_GetPathInfo(pack_file, &info) ? info.modify_time : 0;
+    mount.lock = SDL_CreateMutex();
+    mount.cached = calloc(yep_pack_entry_count(mount.pack) + 1, sizeof(struct mount_cached *));
+    build_tree();
+
+    // yep <mountpoint> -o ro,fsname=<pack> [fuse options...]
+    char options[4200];
+    snprintf(options, sizeof(options), "ro,fsname=%s,subtype=yep", pack_file);
+
+    int fuse_argc = 0;
+    char **fuse_argv = malloc((size_t)(argc - first + 2) * sizeof(char *));
+    fuse_argv[fuse_argc++] = "yep";
+    fuse_argv[fuse_argc++] = argv[first + 1];
+    fuse_argv[fuse_argc++] = "-o";
+    fuse_argv[fuse_argc++] = options;
+    for(int i = first + 2; i < argc; i++)
+        fuse_argv[fuse_argc++] = argv[i];
+
+    yep_logf(yep_log_info, "Mounting %s (%u entries) on %s\n", pack_file, yep_pack_entry_count(mount.pack), argv[first + 1]);
+    int result = fuse_main(fuse_argc, fuse_argv, &mount_operations, NULL);
+
+    free(fuse_argv);
+    for(uint32_t i = 0; i < yep_pack_entry_count(mount.pack); i++) {
+        if(mount.cached[i] != NULL) {
+            free(mount.cached[i]->data);
+            free(mount.cached[i]);
+        }
+    }
+    free(mount.cached);
+    free_tree();
+    SDL_DestroyMutex(mount.lock);
+    yep_pack_close(mount.pack);
+
+    yep_shutdown();
+    return result;
+}
+
+#else
+
+int yep_cmd_mount(int argc, char **argv) {
+    (void)argc; (void)argv;
+    fprintf(stderr, "yep was built without FUSE support, reconfigure with -DYEP_FUSE_SUPPORT=ON\n");
+    return 1;
+}
+
+#endif
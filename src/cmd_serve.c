@@ -0,0 +1,461 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep serve [--cache-limit <MB>] <socket_path> [pack.yep...]
+
+    Keeps packs open and answers extraction requests from other processes over a Unix
+    domain socket until interrupted, see yep_client_connect(). The listed packs are opened
+    right away, any other pack is opened the first time a client asks for it, and a pack
+    that was repacked since is reopened on the next request.
+
+    Payloads are never copied through the socket. Uncompressed entries are answered with a
+    descriptor of the pack file and their offset, compressed ones are decoded once into an
+    in-memory file that is kept for later requests, up to the cache limit.
+*/
+
+// memfd_create()
+#ifdef __linux__
+    #define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+#include "yep_cmd.h"
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <limits.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+#endif
+
+#ifndef _WIN32
+
+#define SERVE_DEFAULT_CACHE_MB 512
+
+struct served_entry {
+    int fd;                 // decoded payload, -1 until first requested
+    uint64_t size;
+};
+
+struct served_pack {
+    char *path;
+    struct yep_pack *pack;
+    int fd;                 // the same version of the file as the mapping
+    struct served_entry *decoded;
+};
+
+struct serve_client {
+    int fd;
+    size_t have;
+    struct yep_serve_request request;
+};
+
+static volatile sig_atomic_t serve_stop = 0;
+
+static struct served_pack *served_packs = NULL;
+static uint32_t served_count = 0;
+
+static uint64_t cache_limit = 0;
+static uint64_t cache_used = 0;
+
+static void on_interrupt(int sig) {
+    (void)sig;
+    serve_stop = 1;
+}
+
+static void unload_pack(struct served_pack *served) {
+    if(served->decoded != NULL) {
+        for(uint32_t i = 0; i < yep_pack_entry_count(served->pack); i++) {
+            if(served->decoded[i].fd >= 0) {
+                close(served->decoded[i].fd);
+                cache_used -= served->decoded[i].size;
+            }
+        }
+    }
+    free(served->decoded);
+    served->decoded = NULL;
+
+    yep_pack_close(served->pack);
+    served->pack = NULL;
+    if(served->fd >= 0)
+        close(served->fd);
+    served->fd = -1;
+}
+
+static bool load_pack(struct served_pack *served) {
+    // a repack can land between opening the descriptor and mapping, retry until both agree
+    for(int attempt = 0; attempt < 3; attempt++) {
+        served->fd = open(served->path, O_RDONLY | O_CLOEXEC);
+        if(served->fd < 0)
+            return false;
+
+        served->pack = yep_pack_open(served->path);
+        if(served->pack == NULL) {
+            close(served->fd);
+            served->fd = -1;
+            return false;
+        }
+
+        struct stat opened, current;
+        if(fstat(served->fd, &opened) == 0 && stat(served->path, &current) == 0 &&
+           opened.st_ino == current.st_ino && opened.st_dev == current.st_dev && !yep_pack_is_stale(served->pack)) {
+            uint32_t count = yep_pack_entry_count(served->pack);
+            served->decoded = malloc((count ? count : 1) * sizeof(struct served_entry));
+            for(uint32_t i = 0; i < count; i++)
+                served->decoded[i] = (struct served_entry){ .fd = -1, .size = 0 };
+
+            yep_logf(yep_log_info, "Serving %s (%u entries)\n", served->path, count);
+            return true;
+        }
+
+        unload_pack(served);
+    }
+    return false;
+}
+
+static struct served_pack *find_pack(const char *path) {
+    for(uint32_t i = 0; i < served_count; i++) {
+        struct served_pack *served = &served_packs[i];
+        if(strcmp(served->path, path) != 0)
+            continue;
+
+        if(served->pack != NULL && yep_pack_is_stale(served->pack)) {
+            yep_logf(yep_log_info, "%s changed, reopening it\n", path);
+            unload_pack(served);
+        }
+        if(served->pack == NULL && !load_pack(served))
+            return NULL;
+        return served;
+    }
+
+    served_packs = realloc(served_packs, (served_count + 1) * sizeof(struct served_pack));
+    struct served_pack *served = &served_packs[served_count];
+    *served = (struct served_pack){ .path = strdup(path), .pack = NULL, .fd = -1, .decoded = NULL };
+    if(!load_pack(served)) {
+        free(served->path);
+        return NULL;
+    }
+
+    served_count++;
+    return served;
+}
+
+// a read-only in-memory file holding data, -1 on failure. The same descriptor is handed to
+// every client, so none of them may be able to resize or rewrite it under the others
+static int memory_file(const void *data, size_t size) {
+#ifdef __linux__
+    int fd = memfd_create("yep", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    char name[64];
+    snprintf(name, sizeof(name), "/yep-serve-%ld-%p", (long)getpid(), data);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+#endif
+    if(fd < 0)
+        return -1;
+
+    bool ok = true;
+    const char *bytes = data;
+    size_t left = size;
+    while(left > 0) {
+        ssize_t written = write(fd, bytes, left);
+        if(written < 0 && errno == EINTR)
+            continue;
+        if(written <= 0) {
+            ok = false;
+            break;
+        }
+        bytes += written;
+        left -= (size_t)written;
+    }
+
+#ifdef __linux__
+    ok = ok && fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0;
+#else
+    // no seals here, clients get a descriptor that was opened read-only instead
+    int read_only = ok ? shm_open(name, O_RDONLY, 0) : -1;
+    shm_unlink(name);
+    close(fd);
+    fd = read_only;
+    ok = fd >= 0;
+    if(ok)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    if(!ok) {
+        if(fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// false if the client has to be dropped
+static bool send_response(int socket, const struct yep_serve_response *response, int fd) {
+    struct iovec iov = { .iov_base = (void *)response, .iov_len = sizeof(*response) };
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr message = { .msg_iov = &iov, .msg_iovlen = 1 };
+    if(fd >= 0) {
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(header), &fd, sizeof(int));
+    }
+
+    // responses are tiny, so a client whose socket buffer is full has stopped reading.
+    // the server is single threaded, it drops that client instead of blocking on it
+    ssize_t sent;
+    while((sent = sendmsg(socket, &message, MSG_DONTWAIT)) < 0 && errno == EINTR)
+        ;
+    return sent == (ssize_t)sizeof(*response);
+}
+
+static bool handle_request(int socket, struct yep_serve_request *request) {
+    struct yep_serve_response response = { .status = YEP_SERVE_BAD_REQUEST, .data_type = 0, .offset = 0, .size = 0 };
+    int fd = -1;
+    int owned_fd = -1;      // closed after sending, not cached
+
+    request->pack[sizeof(request->pack) - 1] = '\0';
+    request->handle[sizeof(request->handle) - 1] = '\0';
+
+    if(request->magic != YEP_SERVE_MAGIC || request->version != YEP_SERVE_VERSION) {
+        return send_response(socket, &response, -1);
+    }
+
+    struct served_pack *served = find_pack(request->pack);
+    int32_t index = served != NULL ? yep_pack_find(served->pack, request->handle) : -1;
+
+    if(served == NULL) {
+        response.status = YEP_SERVE_NO_PACK;
+    }
+    else if(index < 0) {
+        response.status = YEP_SERVE_NO_ENTRY;
+    }
+    else {
+        const struct yep_entry *entry = yep_pack_entry(served->pack, (uint32_t)index);
+        struct served_entry *decoded = &served->decoded[index];
+        response.data_type = entry->data_type;
+
+        // animations are stored with delta frames, they always go through yep_pack_extract()
+        if(entry->compression_type == YEP_COMPRESSION_NONE && entry->data_type != YEP_DATATYPE_ANIMATION) {
+            response.status = YEP_SERVE_OK;
+            response.offset = entry->offset;
+            response.size = entry->size;
+            fd = served->fd;
+        }
+        else if(decoded->fd >= 0) {
+            response.status = YEP_SERVE_OK;
+            response.size = decoded->size;
+            fd = decoded->fd;
+        }
+        else {
+            struct yep_data_info info = yep_pack_extract(served->pack, (uint32_t)index);
+            fd = info.data != NULL ? memory_file(info.data, info.size) : -1;
+            response.status = fd >= 0 ? YEP_SERVE_OK : YEP_SERVE_FAILED;
+            response.size = info.size;
+            free(info.data);
+
+            if(fd >= 0 && cache_used + info.size <= cache_limit) {
+                decoded->fd = fd;
+                decoded->size = info.size;
+                cache_used += info.size;
+            }
+            else {
+                owned_fd = fd;
+            }
+        }
+    }
+
+    bool sent = send_response(socket, &response, fd);
+    if(owned_fd >= 0)
+        close(owned_fd);
+    return sent;
+}
+
+static int listen_on(const char *socket_path) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if(strlen(socket_path) >= sizeof(address.sun_path)) {
+        yep_logf(yep_log_error, "Socket path %s is too long\n", socket_path);
+        return -1;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    // a socket left behind by a crashed server is replaced, a live one is not
+    struct yep_client *running = yep_client_connect(socket_path);
+    if(running != NULL) {
+        yep_client_close(running);
+        yep_logf(yep_log_error, "A yep server is already listening on %s\n", socket_path);
+        return -1;
+    }
+    unlink(socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+        return -1;
+
+    // only the user running the server may connect
+    mode_t mask = umask(0077);
+    bool bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    umask(mask);
+
+    if(!bound || listen(fd, 16) != 0) {
+        yep_logf(yep_log_error, "Cannot listen on %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int serve(const char *socket_path) {
+    int listener = listen_on(socket_path);
+    if(listener < 0)
+        return 1;
+
+    struct serve_client *clients = NULL;
+    uint32_t client_count = 0;
+    struct pollfd *fds = NULL;
+
+    yep_logf(yep_log_info, "Listening on %s (ctrl+c to stop)\n", socket_path);
+
+    while(!serve_stop) {
+        fds = realloc(fds, (client_count + 1) * sizeof(struct pollfd));
+        fds[0] = (struct pollfd){ .fd = listener, .events = POLLIN, .revents = 0 };
+        for(uint32_t i = 0; i < client_count; i++)
+            fds[i + 1] = (struct pollfd){ .fd = clients[i].fd, .events = POLLIN, .revents = 0 };
+
+        if(poll(fds, client_count + 1, -1) < 0) {
+            if(errno == EINTR)
+                continue;
+            yep_logf(yep_log_error, "poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        // partial requests are buffered per client, so a slow one cannot block the rest
+        for(uint32_t i = client_count; i-- > 0;) {
+            if(fds[i + 1].revents == 0)
+                continue;
+
+            struct serve_client *client = &clients[i];
+            ssize_t received = recv(client->fd, (char *)&client->request + client->have, sizeof(client->request) - client->have, 0);
+            if(received < 0 && errno == EINTR)
+                continue;
+
+            if(received <= 0) {
+                close(client->fd);
+                clients[i] = clients[--client_count];
+                continue;
+            }
+
+            client->have += (size_t)received;
+            if(client->have == sizeof(client->request)) {
+                client->have = 0;
+                if(!handle_request(client->fd, &client->request)) {
+                    yep_logf(yep_log_warning, "Dropping a client that stopped reading its responses\n");
+                    close(client->fd);
+                    clients[i] = clients[--client_count];
+                }
+            }
+        }
+
+        if(fds[0].revents & POLLIN) {
+            int fd = accept(listener, NULL, NULL);
+            if(fd >= 0) {
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+                clients = realloc(clients, (client_count + 1) * sizeof(struct serve_client));
+                clients[client_count].fd = fd;
+                clients[client_count].have = 0;
+                client_count++;
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < client_count; i++)
+        close(clients[i].fd);
+    free(clients);
+    free(fds);
+
+    close(listener);
+    unlink(socket_path);
+    return 0;
+}
+
+int yep_cmd_serve(int argc, char **argv) {
+    cache_limit = (uint64_t)SERVE_DEFAULT_CACHE_MB << 20;
+
+    int first = 0;
+    bool valid = true;
+    if(argc >= 2 && strcmp(argv[0], "--cache-limit") == 0) {
+        // whole megabytes, strtoull would take a sign and wrap it
+        char *end = NULL;
+        errno = 0;
+        unsigned long long megabytes = strtoull(argv[1], &end, 10);
+        valid = argv[1][0] >= '0' && argv[1][0] <= '9' && *end == '\0' && errno == 0 &&
+                megabytes <= (UINT64_MAX >> 20);
+        cache_limit = (uint64_t)megabytes << 20;
+        first = 2;
+    }
+
+    if(!valid || first >= argc) {
+        fprintf(stderr, "Usage: yep serve [--cache-limit <MB>] <socket_path> [pack.yep...]\n");
+        return 1;
+    }
+    const char *socket_path = argv[first];
+
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+    signal(SIGPIPE, SIG_IGN);
+
+    yep_initialize();
+
+    // requests name packs by absolute path
+    for(int i = first + 1; i < argc; i++) {
+        char resolved[PATH_MAX];
+        if(realpath(argv[i], resolved) == NULL || find_pack(resolved) == NULL)
+            yep_logf(yep_log_warning, "Cannot serve %s, skipping it\n", argv[i]);
+    }
+
+    int result = serve(socket_path);
+
+    for(uint32_t i = 0; i < served_count; i++) {
+        unload_pack(&served_packs[i]);
+        free(served_packs[i].path);
+    }
+    free(served_packs);
+
+    yep_shutdown();
+    return result;
+}
+
+#else
+
+int yep_cmd_serve(int argc, char **argv) {
+    (void)argc; (void)argv;
+    fprintf(stderr, "yep serve needs Unix domain sockets, it is not supported on this platform\n");
+    return 1;
+}
+
+#endif
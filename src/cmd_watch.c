@@ -0,0 +1,198 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep watch [pack options] <input_directory> <output_file.yep>
+
+    Packs once, then repacks every time something under the input directory changes,
+    until interrupted. Repacks go through the pack cache (<output>.cache unless --cache
+    is given), so only the files that changed are decoded and compressed again, and the
+    new pack replaces the old one with a rename. Engines pick it up through
+    yep_refresh_packs() / yep_pack_is_stale().
+
+    Linux is notified through inotify, other platforms poll the directory tree.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+
+#include <SDL3/SDL.h>
+
+#include "libyep.h"
+#include "yepfs.h"
+#include "yep_cmd.h"
+
+#ifdef __linux__
+    #include <errno.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+// editors save in bursts (temp file, rename, chmod), wait until it settles
+#define WATCH_SETTLE_MS 50
+
+// how often the fallback rescans the tree
+#define WATCH_POLL_MS 250
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void on_interrupt(int sig) {
+    (void)sig;
+    watch_stop = 1;
+}
+
+static bool repack(const char *input_dir, const char *output_file) {
+    Uint64 start = SDL_GetTicksNS();
+
+    if(!yep_force_pack_directory((char *)input_dir, (char *)output_file)) {
+        yep_logf(yep_log_error, "Failed to pack %s, waiting for the next change\n", input_dir);
+        return false;
+    }
+
+    yep_logf(yep_log_info, "Packed %s in %.1f ms\n", output_file, (SDL_GetTicksNS() - start) / 1e6);
+    return true;
+}
+
+#ifdef __linux__
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB)
+
+static SDL_EnumerationResult SDLCALL add_watch_callback(void *userdata, const char *dirname, const char *fname);
+
+// watches a directory and everything below it, adding an existing watch again is harmless
+static void add_watches(int fd, const char *path) {
+    if(inotify_add_watch(fd, path, WATCH_MASK) < 0) {
+        yep_logf(yep_log_warning, "Cannot watch %s: %s\n", path, strerror(errno));
+        return;
+    }
+    SDL_EnumerateDirectory(path, add_watch_callback, &fd);
+}
+
+static SDL_EnumerationResult SDLCALL add_watch_callback(void *userdata, const char *dirname, const char *fname) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%s", dirname, fname);
+
+    SDL_PathInfo info;
+    if(SDL_GetPathInfo(path, &info) && info.type == SDL_PATHTYPE_DIRECTORY)
+        add_watches(*(int *)userdata, path);
+    return SDL_ENUM_CONTINUE;
+}
+
+static int watch_loop(const char *input_dir, const char *output_file) {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) {
+        yep_logf(yep_log_error, "inotify_init1 failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    add_watches(fd, input_dir);
+
+    bool pending = false;
+    Uint64 last_event = 0;
+    char events[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while(!watch_stop) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+        int ready = poll(&pfd, 1, pending ? WATCH_SETTLE_MS : -1);
+        if(ready < 0 && errno != EINTR) {
+            yep_logf(yep_log_error, "poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        // the events only say that something changed, the pack cache works out what
+        if(ready > 0) {
+            while(read(fd, events, sizeof(events)) > 0)
+                ;
+            pending = true;
+            last_event = SDL_GetTicks();
+            continue;
+        }
+
+        if(pending && SDL_GetTicks() - last_event >= WATCH_SETTLE_MS) {
+            pending = false;
+            repack(input_dir, output_file);
+
+            // directories created since the last pack need their own watches
+            add_watches(fd, input_dir);
+        }
+    }
+
+    close(fd);
+    return 0;
+}
+
+#else
+
+struct tree_signature {
+    uint64_t hash;
+};
+
+static SDL_EnumerationResult SDLCALL signature_callback(void *userdata, const char *dirname, const char *fname) {
+    struct tree_signature *signature = userdata;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%s", dirname, fname);
+
+    SDL_PathInfo info;
+    if(!SDL_GetPathInfo(path, &info))
+        return SDL_ENUM_CONTINUE;
+
+    // order independent, enumeration order is not guaranteed
+    uint64_t hash = yep_hash_handle(path);
+    hash ^= (uint64_t)info.modify_time * 0x9E3779B97F4A7C15ull;
+    hash ^= info.size * 0xC2B2AE3D27D4EB4Full;
+    signature->hash += hash * 0x100000001b3ull;
+
+    if(info.type == SDL_PATHTYPE_DIRECTORY)
+        SDL_EnumerateDirectory(path, signature_callback, signature);
+    return SDL_ENUM_CONTINUE;
+}
+
+static uint64_t tree_signature(const char *path) {
+    struct tree_signature signature = {0};
+    SDL_EnumerateDirectory(path, signature_callback, &signature);
+    return signature.hash;
+}
+
+static int watch_loop(const char *input_dir, const char *output_file) {
+    uint64_t signature = tree_signature(input_dir);
+
+    while(!watch_stop) {
+        SDL_Delay(WATCH_POLL_MS);
+
+        uint64_t current = tree_signature(input_dir);
+        if(current == signature)
+            continue;
+
+        // same settling as the inotify path, keep polling until nothing moves
+        do {
+            signature = current;
+            SDL_Delay(WATCH_SETTLE_MS);
+            current = tree_signature(input_dir);
+        } while(current != signature && !watch_stop);
+
+        if(!watch_stop)
+            repack(input_dir, output_file);
+    }
+
+    return 0;
+}
+
+#endif
+
+int yep_watch(const char *input_dir, const char *output_file) {
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+
+    yep_logf(yep_log_info, "Watching %s, writing %s (ctrl+c to stop)\n", input_dir, output_file);
+    repack(input_dir, output_file);
+
+    return watch_loop(input_dir, output_file);
+}
@@ -9,49 +9,17 @@
 #include <string.h>     // for strdup, strcmp, etc.
 #include <stdio.h>      // for printf, FILE, etc.
 #include <stdlib.h>     // for malloc, free, etc.
-#include <stdarg.h>     // for va_list, va_start, va_end
+#include <inttypes.h>   // for PRIx64
 
 #include <zlib.h>       // zlib compression
 #include <SDL3/SDL.h>   // dir traversal
 
 #include "yepfs.h"
 #include "libyep.h"
-
-// holds the reference to the currently open yep file
-char* yep_file_path = NULL;
-FILE *yep_file = NULL;
-uint16_t file_entry_count = 0;
-uint16_t file_version_number = 0;
+#include "yep_internal.h"
 
 struct yep_pack_list yep_pack_list;
 
-/*
-    Trivial temp logger
-*/
-void yep_logf(enum yep_log_level level, const char *fmt, ...) {
-    // Print the level prefix
-    switch(level) {
-        case yep_log_debug:
-            printf("[DEBUG] ");
-            break;
-        case yep_log_info:
-            printf("[INFO] ");
-            break;
-        case yep_log_warning:
-            printf("[WARN] ");
-            break;
-        case yep_log_error:
-            printf("[ERROR] ");
-            break;
-    }
-
-    // Print the actual message
-    va_list args;
-    va_start(args, fmt);
-    vprintf(fmt, args);
-    va_end(args);
-}
-
 /*
     Equivalent to ye_path to help get paths on disk
 */
@@ -129,6 +97,7 @@ int decompress_data(const char* input, size_t input_size, char** output, size_t
 
     if(output_size != stream.total_out){
         yep_logf(yep_log_error,"Error: decompressed size does not match expected size\n");
+        free(*output);
         return -1;
     }
 
@@ -139,11 +108,21 @@ int decompress_data(const char* input, size_t input_size, char** output, size_t
     ============================= TIMESTAMP TRACKING =============================
 */
 
-bool is_dir_outofdate(const char *target_directory, const char *yep_file_path){
+// every path one pack run stats, shared by the up-to-date check, the walk and the pack cache
+static struct yep_stat_cache *yep_pack_stats = NULL;
+
+static void _yep_newest_callback(const char *path, const SDL_PathInfo *info, void *userdata){
+    (void)path;
+    SDL_Time *newest = userdata;
+    if(info->modify_time > *newest)
+        *newest = info->modify_time;
+}
+
+static bool _is_dir_outofdate(struct yep_stat_cache *stats, const char *target_directory, const char *yep_file_path){
     
     SDL_PathInfo dir_info;
     // check if the directory exists
-    if(!yep_get_path_info(target_directory, &dir_info)){
+    if(!yep_stat_cache_get(stats, target_directory, &dir_info)){
         yep_logf(yep_log_error,"Error: directory %s does not exist\n", target_directory);
         return false;
     }
@@ -155,7 +134,7 @@ bool is_dir_outofdate(const char *target_directory, const char *yep_file_path){
 
     // check if the yep file exists
     SDL_PathInfo yep_info;
-    if(!yep_get_path_info(yep_file_path, &yep_info)){
+    if(!yep_stat_cache_get(stats, yep_file_path, &yep_info)){
         yep_logf(yep_log_error,"Error: yep file %s does not exist\n", yep_file_path);
         return false;
     }
@@ -165,8 +144,13 @@ bool is_dir_outofdate(const char *target_directory, const char *yep_file_path){
         return false;
     }
 
-    // if the directory is newer than the yep file, return true
-    if(dir_info.modify_time > yep_info.modify_time){
+    // a file edited in place does not touch its directory, so the whole tree is compared.
+    // the sweep is the one the walk reuses if we end up packing
+    SDL_Time newest = dir_info.modify_time;
+    yep_stat_cache_walk(stats, target_directory, _yep_newest_callback, &newest);
+
+    // if anything in the directory is newer than the yep file, return true
+    if(newest > yep_info.modify_time){
         yep_logf(yep_log_debug,"Directory %s is newer than yep file %s\n", target_directory, yep_file_path);
         return true;
     }
@@ -175,202 +159,977 @@ bool is_dir_outofdate(const char *target_directory, const char *yep_file_path){
     return false;
 }
 
+bool is_dir_outofdate(const char *target_directory, const char *yep_file_path){
+    if(yep_pack_stats != NULL)
+        return _is_dir_outofdate(yep_pack_stats, target_directory, yep_file_path);
+
+    struct yep_stat_cache *stats = yep_stat_cache_create();
+    bool res = _is_dir_outofdate(stats, target_directory, yep_file_path);
+    yep_stat_cache_free(stats);
+    return res;
+}
+
 /*
     ==============================================================================
 */
 
-// utility function via chatgpt - moveme //
+/*
+    ================================ PACK OPTIONS ================================
+*/
 
-void displayProgressBar(int current, int max) {
-    // Calculate the percentage completion
-    float progress = (float)current / max;
-    
-    // Determine the length of the progress bar
-    int barLength = 50;
-    int progressLength = (int)(progress * barLength);
-    
-    // Clear the current line
-    printf("\r");
-
-    // Display the progress bar
-    printf("[");
-    for (int i = 0; i < barLength; ++i) {
-        if (i < progressLength) {
-            printf("=");
-        } else {
-            printf(" ");
-        }
+// the options every pack call uses, see yep_set_pack_options()
+static struct yep_pack_options yep_options = {
+    .progress_callback = NULL,
+    .progress_userdata = NULL,
+    .progress_interval_ms = 100,
+    .decode_images = false,
+    .image_mips = false,
+    .decode_audio = false,
+    .compile_lua = false,
+    .lua_debug_info = false,
+    .bundle_animations = false,
+    .animation_delta = false,
+    .atlas_max_size = 0,
+    .atlas_page_size = 1024,
+    .report_path = NULL,
+    .header_path = NULL,
+    .cache_path = NULL,
+    .depfile_path = NULL,
+};
+
+void yep_pack_options_init(struct yep_pack_options *options){
+    memset(options, 0, sizeof(*options));
+    options->progress_interval_ms = 100;
+    options->atlas_page_size = 1024;
+}
+
+void yep_set_pack_options(const struct yep_pack_options *options){
+    if(options == NULL)
+        yep_pack_options_init(&yep_options);
+    else
+        yep_options = *options;
+}
+
+/*
+    ================================ SHARED MEMORY ===============================
+*/
+
+// see yep_use_shared_memory()
+static bool yep_shared_enabled = false;
+static size_t yep_shared_cache_size = 0;
+
+// every version of a pack file gets its own segment, a repacked file never sees a stale index
+static uint64_t _yep_shared_identity(SDL_Time modify_time, uint64_t size){
+    return ((uint64_t)modify_time ^ (size * 0x9E3779B97F4A7C15ull)) | 1;
+}
+
+void yep_use_shared_memory(bool enabled, size_t cache_size){
+    yep_shared_enabled = enabled;
+    yep_shared_cache_size = cache_size;
+}
+
+bool yep_pack_unlink_shared(const char *file){
+    SDL_PathInfo info;
+    if(!SDL_GetPathInfo(file, &info))
+        return false;
+
+    return yep_shared_unlink(file, _yep_shared_identity(info.modify_time, info.size));
+}
+
+
+/*
+    ================================ PACK HANDLES ================================
+*/
+
+// the parsed header table of an open pack, see yep_pack_open()
+struct yep_pack {
+    char *path;
+
+    const uint8_t *base;    // whole pack file, mapped read-only (or embedded in memory)
+    size_t size;
+    bool mapped;            // false if base belongs to the caller
+    SDL_Time modify_time;   // of the file when it was mapped, see yep_pack_is_stale()
+
+    char *loose_root;       // set if the pack is a mounted directory, entries are read from here
+    int loose_watch;
+    int64_t *loose_times;   // modification time of every file when it was scanned
+
+    struct yep_shared *shared;  // set if the index lives in shared memory, see yep_use_shared_memory()
+
+    uint8_t version;
+    uint16_t entry_count;
+    struct yep_entry *entries;
+
+    // open addressing table of entry indices keyed by name hash (UINT32_MAX is empty)
+    uint64_t *hashes;
+    uint32_t *buckets;
+    uint32_t bucket_mask;
+
+    uint64_t fingerprint;   // hash of every entry name in order, see yep_pack_fingerprint()
+
+    // images packed into atlases, indexed the same way by their original handle
+    uint32_t region_count;
+    struct yep_atlas_region *regions;
+    const char **region_names;      // point into the mapping
+    uint64_t *region_hashes;
+    uint32_t *region_buckets;
+    uint32_t region_mask;
+};
+
+uint64_t yep_hash_handle(const char *handle){
+    // 64 bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    while(*handle){
+        hash ^= (uint8_t)*handle++;
+        hash *= 0x100000001b3ull;
     }
-    printf("] %.2f%% (%d/%d)", progress * 100, current, max);
-    
-    // Flush the output to ensure it's immediately displayed
-    fflush(stdout);
+    return hash;
 }
 
-///////////////////////////////////////////
+const char *yep_compression_name(uint8_t compression_type){
+    switch(compression_type){
+        case YEP_COMPRESSION_NONE: return "none";
+        case YEP_COMPRESSION_ZLIB: return "zlib";
+        case YEP_COMPRESSION_LPC:  return "lpc";
+        case YEP_COMPRESSION_FILTERED_ZLIB: return "fzlib";
+        default:                   return "unknown";
+    }
+}
 
-bool _yep_open_file(const char *file){
-    // if we already have this file open, don't open it again
-    if(yep_file_path != NULL && strcmp(yep_file_path, file) == 0){
-        return true;
+const char *yep_datatype_name(uint8_t data_type){
+    switch(data_type){
+        case YEP_DATATYPE_MISC:          return "misc";
+        case YEP_DATATYPE_IMAGE:         return "image";
+        case YEP_DATATYPE_PCM:           return "pcm";
+        case YEP_DATATYPE_LUA_BYTECODE:  return "lua_bytecode";
+        case YEP_DATATYPE_ANIMATION:     return "animation";
+        case YEP_DATATYPE_ATLAS:         return "atlas";
+        default:                         return "unknown";
     }
+}
 
-    yep_file = fopen(file, "rb");
-    if (yep_file == NULL) {
-        yep_logf(yep_log_error,"Error opening yep file\n");
-        return false;
+/*
+    ================================ EMBEDDED PACKS ==============================
+*/
+
+struct yep_embedded_pack {
+    char *file;
+    const uint8_t *data;
+    size_t size;
+    char *directory;        // a mounted loose directory instead of data (NULL otherwise)
+
+    struct yep_embedded_pack *next;
+};
+
+// registered once at startup and read after, so no locking
+static struct yep_embedded_pack *yep_embedded_packs = NULL;
+
+static const struct yep_embedded_pack *_yep_find_embedded(const char *file){
+    for(struct yep_embedded_pack *itr = yep_embedded_packs; itr != NULL; itr = itr->next){
+        if(strcmp(itr->file, file) == 0)
+            return itr;
     }
+    return NULL;
+}
+
+// defined with the legacy API below
+static void _yep_drop_current(const char *file);
 
-    // set the file path
-    if(yep_file_path != NULL)
-        free(yep_file_path);
+// the registration for file, created empty if there is none yet
+static struct yep_embedded_pack *_yep_registration(const char *file){
+    struct yep_embedded_pack *existing = (struct yep_embedded_pack *)_yep_find_embedded(file);
+    if(existing != NULL)
+        return existing;
 
-    yep_file_path = strdup(file);
+    struct yep_embedded_pack *embedded = calloc(1, sizeof(struct yep_embedded_pack));
+    embedded->file = strdup(file);
+    embedded->next = yep_embedded_packs;
+    yep_embedded_packs = embedded;
+    return embedded;
+}
+
+bool yep_register_embedded_pack(const char *file, const void *data, size_t size){
+    if(file == NULL || data == NULL)
+        return false;
 
-    // read the version number (byte 0-1)
-    fread(&file_version_number, sizeof(uint8_t), 1, yep_file);
+    _yep_drop_current(file);
 
-    // read the entry count (byte 2-3)
-    fread(&file_entry_count, sizeof(uint16_t), 1, yep_file);
+    struct yep_embedded_pack *embedded = _yep_registration(file);
+    free(embedded->directory);
+    embedded->directory = NULL;
+    embedded->data = data;
+    embedded->size = size;
 
-    if(file_version_number != YEP_CURRENT_FORMAT_VERSION){
-        yep_logf(yep_log_error,"Error: file version number (%d) does not match current version number (%d)\n", file_version_number, YEP_CURRENT_FORMAT_VERSION);
+    yep_logf(yep_log_debug,"Registered embedded pack %s (%zu bytes)\n", file, size);
+    return true;
+}
+
+bool yep_mount_directory(const char *file, const char *directory){
+    if(file == NULL)
         return false;
+
+    _yep_drop_current(file);
+
+    // NULL goes back to the pack on disk
+    if(directory == NULL){
+        struct yep_embedded_pack *existing = (struct yep_embedded_pack *)_yep_find_embedded(file);
+        if(existing != NULL && existing->directory != NULL){
+            free(existing->directory);
+            existing->directory = NULL;
+            existing->data = NULL;
+        }
+        return true;
     }
 
+    struct yep_embedded_pack *embedded = _yep_registration(file);
+    free(embedded->directory);
+    embedded->directory = strdup(directory);
+    embedded->data = NULL;
+    embedded->size = 0;
+
+    yep_logf(yep_log_debug,"Mounted directory %s as %s\n", directory, file);
     return true;
 }
 
-void _yep_close_file(){
-    if(yep_file != NULL){
-        fclose(yep_file);
-        yep_file = NULL;
+/*
+    Indexes the regions of every atlas table in the pack, tables are never compressed
+    so their records are read straight out of the mapping
+*/
+static bool _yep_index_regions(struct yep_pack *pack){
+    uint32_t total = 0;
+    for(uint32_t i = 0; i < pack->entry_count; i++){
+        const struct yep_entry *entry = &pack->entries[i];
+        if(entry->data_type != YEP_DATATYPE_ATLAS)
+            continue;
+
+        struct yep_atlas_table_header header;
+        if(entry->compression_type != YEP_COMPRESSION_NONE || !yep_atlas_table_parse(pack->base + entry->offset, entry->size, &header)){
+            yep_logf(yep_log_error,"Error: atlas table %s in %s is invalid\n", entry->name, pack->path);
+            return false;
+        }
+        total += header.region_count;
+    }
+
+    if(total == 0)
+        return true;
+
+    pack->region_count = total;
+    pack->regions = calloc(total, sizeof(struct yep_atlas_region));
+    pack->region_names = calloc(total, sizeof(const char *));
+    pack->region_hashes = calloc(total, sizeof(uint64_t));
+
+    uint32_t bucket_count = 16;
+    while(bucket_count < total * 2)
+        bucket_count <<= 1;
+    pack->region_mask = bucket_count - 1;
+    pack->region_buckets = malloc(bucket_count * sizeof(uint32_t));
+    memset(pack->region_buckets, 0xFF, bucket_count * sizeof(uint32_t));
+
+    uint32_t index = 0;
+    for(uint32_t i = 0; i < pack->entry_count; i++){
+        const struct yep_entry *entry = &pack->entries[i];
+        if(entry->data_type != YEP_DATATYPE_ATLAS)
+            continue;
+
+        const uint8_t *table = pack->base + entry->offset;
+        struct yep_atlas_table_header header;
+        yep_atlas_table_parse(table, entry->size, &header);
+
+        const uint8_t *page_records = table + sizeof(header);
+        const uint8_t *region_records = page_records + (size_t)header.page_count * sizeof(struct yep_atlas_page_record);
+
+        for(uint32_t r = 0; r < header.region_count; r++, index++){
+            struct yep_atlas_region_record record;
+            memcpy(&record, region_records + (size_t)r * sizeof(record), sizeof(record));
+
+            struct yep_atlas_page_record page;
+            if(record.page >= header.page_count){
+                yep_logf(yep_log_error,"Error: atlas region %.63s points at a missing page\n", record.name);
+                return false;
+            }
+            memcpy(&page, page_records + (size_t)record.page * sizeof(page), sizeof(page));
+            page.name[63] = '\0';
+
+            int32_t page_entry = yep_pack_find(pack, page.name);
+            if(page_entry < 0 || page.width == 0 || page.height == 0){
+                yep_logf(yep_log_error,"Error: atlas page %s is missing from %s\n", page.name, pack->path);
+                return false;
+            }
+
+            pack->regions[index] = (struct yep_atlas_region){
+                .page = (uint32_t)page_entry,
+                .x = record.x,
+                .y = record.y,
+                .width = record.width,
+                .height = record.height,
+                .u0 = (float)record.x / (float)page.width,
+                .v0 = (float)record.y / (float)page.height,
+                .u1 = (float)(record.x + record.width) / (float)page.width,
+                .v1 = (float)(record.y + record.height) / (float)page.height,
+            };
+
+            // names are written null padded, the last byte is always zero
+            const char *name = (const char *)(region_records + (size_t)r * sizeof(record));
+            pack->region_names[index] = name[63] == '\0' ? name : "";
+            pack->region_hashes[index] = yep_hash_handle(pack->region_names[index]);
+
+            uint32_t slot = (uint32_t)pack->region_hashes[index] & pack->region_mask;
+            while(pack->region_buckets[slot] != UINT32_MAX)
+                slot = (slot + 1) & pack->region_mask;
+            pack->region_buckets[slot] = index;
+        }
+    }
+
+    return true;
+}
+
+// releases the pack bytes if we mapped them ourselves
+static void _yep_release(const uint8_t *base, size_t size, bool mapped){
+    if(mapped)
+        yep_unmap_file(base, size);
+}
+
+// size the table to at most 50% load
+static uint32_t _yep_bucket_count(uint16_t entry_count){
+    uint32_t bucket_count = 16;
+    while(bucket_count < (uint32_t)entry_count * 2)
+        bucket_count <<= 1;
+    return bucket_count;
+}
+
+static void _yep_alloc_index(struct yep_pack *pack, uint16_t entry_count){
+    pack->entry_count = entry_count;
+    pack->entries = calloc(entry_count ? entry_count : 1, sizeof(struct yep_entry));
+    pack->hashes = calloc(entry_count ? entry_count : 1, sizeof(uint64_t));
+
+    uint32_t bucket_count = _yep_bucket_count(entry_count);
+    pack->bucket_mask = bucket_count - 1;
+    pack->buckets = malloc(bucket_count * sizeof(uint32_t));
+    memset(pack->buckets, 0xFF, bucket_count * sizeof(uint32_t));
+
+    pack->fingerprint = 0xcbf29ce484222325ull;
+}
 
-        if(yep_file_path != NULL)
-            free(yep_file_path);
+// adds entry i (already filled in) to the hash table and the fingerprint, in index order
+static void _yep_index_entry(struct yep_pack *pack, uint32_t i){
+    const struct yep_entry *entry = &pack->entries[i];
+    pack->hashes[i] = yep_hash_handle(entry->name);
 
-        file_entry_count = 0;
-        file_version_number = 0;
+    // FNV-1a over the names including their terminators, so ids only match the same layout
+    for(const char *c = entry->name; ; c++){
+        pack->fingerprint ^= (uint8_t)*c;
+        pack->fingerprint *= 0x100000001b3ull;
+        if(*c == '\0')
+            break;
     }
+
+    uint32_t slot = (uint32_t)pack->hashes[i] & pack->bucket_mask;
+    while(pack->buckets[slot] != UINT32_MAX)
+        slot = (slot + 1) & pack->bucket_mask;
+    pack->buckets[slot] = i;
 }
 
 /*
-    Takes in references to where to output the data if found, and returns true if found, false if not found
+    Points the index of a pack into its shared memory segment, true if another process
+    already built it (false means parse it as usual, privately or into the segment)
 */
-bool _yep_seek_header(const char *handle, char *name, uint32_t *offset, uint32_t *size, uint8_t *compression_type, uint32_t *uncompressed_size, uint8_t *data_type){
-    // go to the beginning of the header section (3 byte) offset from beginning
-    fseek(yep_file, 3, SEEK_SET);
+static bool _yep_attach_shared(struct yep_pack *pack, uint16_t entry_count, uint64_t shared_identity){
+    struct yep_shared_index index;
+    pack->shared = yep_shared_open(pack->path, shared_identity, entry_count, _yep_bucket_count(entry_count), yep_shared_cache_size, &index);
+    if(pack->shared == NULL){
+        _yep_alloc_index(pack, entry_count);
+        return false;
+    }
 
-    /*
-        Its simplist to just read the whole header into memory (the name is most of it) to
-        keep ourselves aligned with the headers list
-    */
-    for(size_t i = 0; i < file_entry_count; i++){
-        // printf("Searching for %s\n", handle);
+    pack->entry_count = entry_count;
+    pack->entries = index.entries;
+    pack->hashes = index.hashes;
+    pack->buckets = index.buckets;
+    pack->bucket_mask = index.bucket_mask;
+    pack->fingerprint = index.ready ? index.fingerprint : 0xcbf29ce484222325ull;
+    return index.ready;
+}
 
-        // 64 bytes - name of the resource
-        fread(name, sizeof(char), 64, yep_file);
+/*
+    Parses and indexes the header table of a pack that is already in memory
+*/
+static struct yep_pack *_yep_pack_index(const char *file, const uint8_t *base, size_t size, bool mapped, uint64_t shared_identity){
+    // byte 0 is the version number, bytes 1-2 are the entry count
+    if(size < 3){
+        yep_logf(yep_log_error,"Error: %s is too small to be a yep file\n", file);
+        _yep_release(base, size, mapped);
+        return NULL;
+    }
 
-        // printf("Comparing against %s\n", name);
+    uint8_t version = base[0];
+    uint16_t entry_count;
+    memcpy(&entry_count, base + 1, sizeof(uint16_t));
 
-        // 4 bytes - offset of the resource
-        fread(offset, sizeof(uint32_t), 1, yep_file);
+    if(version != YEP_CURRENT_FORMAT_VERSION){
+        yep_logf(yep_log_error,"Error: file version number (%d) does not match current version number (%d)\n", version, YEP_CURRENT_FORMAT_VERSION);
+        _yep_release(base, size, mapped);
+        return NULL;
+    }
 
-        // 4 bytes - size of the resource
-        fread(size, sizeof(uint32_t), 1, yep_file);
+    if(3 + (size_t)entry_count * YEP_HEADER_SIZE_BYTES > size){
+        yep_logf(yep_log_error,"Error: header table of %s is truncated\n", file);
+        _yep_release(base, size, mapped);
+        return NULL;
+    }
 
-        // 1 byte - compression type
-        fread(compression_type, sizeof(uint8_t), 1, yep_file);
+    struct yep_pack *pack = calloc(1, sizeof(struct yep_pack));
+    pack->path = strdup(file);
+    pack->base = base;
+    pack->size = size;
+    pack->mapped = mapped;
+    pack->version = version;
+
+    bool index_ready = false;
+    if(shared_identity != 0)
+        index_ready = _yep_attach_shared(pack, entry_count, shared_identity);
+    else
+        _yep_alloc_index(pack, entry_count);
+
+    const uint8_t *header = base + 3;
+    for(uint32_t i = 0; i < entry_count && !index_ready; i++, header += YEP_HEADER_SIZE_BYTES){
+        struct yep_entry *entry = &pack->entries[i];
+
+        // header fields are unaligned, so copy them out
+        memcpy(entry->name, header, 64);
+        entry->name[63] = '\0';
+        memcpy(&entry->offset, header + 64, sizeof(uint32_t));
+        memcpy(&entry->size, header + 68, sizeof(uint32_t));
+        entry->compression_type = header[72];
+        memcpy(&entry->uncompressed_size, header + 73, sizeof(uint32_t));
+        entry->data_type = header[77];
+
+        if((size_t)entry->offset + entry->size > size){
+            yep_logf(yep_log_error,"Error: entry %s in %s points outside the file\n", entry->name, file);
+            yep_pack_close(pack);
+            return NULL;
+        }
 
-        // 4 bytes - uncompressed size
-        fread(uncompressed_size, sizeof(uint32_t), 1, yep_file);
+        _yep_index_entry(pack, i);
+    }
 
-        // 1 byte - data type
-        fread(data_type, sizeof(uint8_t), 1, yep_file);
+    if(pack->shared != NULL && !index_ready)
+        yep_shared_publish(pack->shared, pack->fingerprint);
 
-        // if the name matches, we found the header
-        if(strcmp(handle, name) == 0){
-            return true;
-        }
+    if(!_yep_index_regions(pack)){
+        yep_pack_close(pack);
+        return NULL;
     }
-    return false;
+
+    return pack;
 }
 
-struct yep_data_info yep_extract_data(const char *file, const char *handle){
-    if(!_yep_open_file(file)){
-        yep_logf(yep_log_warning,"Error opening yep file %s\n", file);
-        return (struct yep_data_info){.data = NULL, .size = 0};
+/*
+    Indexes a mounted directory (see yeploose.c), entries are the files as they are on disk
+*/
+static struct yep_pack *_yep_pack_open_loose(const char *file, const char *directory){
+    struct yep_pack *pack = calloc(1, sizeof(struct yep_pack));
+    pack->path = strdup(file);
+    pack->loose_root = strdup(directory);
+    pack->version = YEP_CURRENT_FORMAT_VERSION;
+
+    // watch before scanning, so nothing that changes in between is missed
+    pack->loose_watch = yep_loose_watch_open();
+
+    struct yep_loose_file *files;
+    uint32_t count;
+    if(!yep_loose_scan(directory, pack->loose_watch, &files, &count)){
+        yep_pack_close(pack);
+        return NULL;
     }
 
-    // printf("File: %s\n", yep_file_path);
-    // printf("    Version number: %d\n", file_version_number);
-    // printf("    Entry count: %d\n", file_entry_count);
+    _yep_alloc_index(pack, (uint16_t)count);
+    pack->loose_times = calloc(count ? count : 1, sizeof(int64_t));
+    for(uint32_t i = 0; i < count; i++){
+        pack->loose_times[i] = files[i].modify_time;
+        struct yep_entry *entry = &pack->entries[i];
+        memcpy(entry->name, files[i].name, sizeof(entry->name));
+        entry->offset = 0;
+        entry->size = files[i].size;
+        entry->compression_type = YEP_COMPRESSION_NONE;
+        entry->uncompressed_size = files[i].size;
+        entry->data_type = YEP_DATATYPE_MISC;
+        _yep_index_entry(pack, i);
+    }
+    free(files);
 
-    // setup the data we will seek out of the yep file
-    char name[64];
-    uint32_t offset;
-    uint32_t size;
-    uint8_t compression_type;
-    uint32_t uncompressed_size;
-    uint8_t data_type;
+    yep_logf(yep_log_debug,"Serving %s from %s (%u files)\n", file, directory, count);
+    return pack;
+}
 
-    // try to get our header
-    if(!_yep_seek_header(handle, name, &offset, &size, &compression_type, &uncompressed_size, &data_type)){
-        yep_logf(yep_log_warning,"Handle \"%s\" does not exist in yep file %s\n", handle, file);
-        return (struct yep_data_info){.data = NULL, .size = 0};
+struct yep_pack *yep_pack_open(const char *file){
+    // packs embedded into the binary never touch the disk
+    const struct yep_embedded_pack *embedded = _yep_find_embedded(file);
+    if(embedded != NULL && embedded->directory != NULL)
+        return _yep_pack_open_loose(file, embedded->directory);
+    if(embedded != NULL && embedded->data != NULL)
+        return _yep_pack_index(file, embedded->data, embedded->size, false, 0);
+
+    // taken before mapping, so a repack in between shows up as stale rather than being missed
+    SDL_PathInfo info;
+    SDL_Time modify_time = SDL_GetPathInfo(file, &info) ? info.modify_time : 0;
+
+    size_t size;
+    const uint8_t *base = yep_map_file(file, &size);
+    if(base == NULL){
+        yep_logf(yep_log_error,"Error opening yep file %s\n", file);
+        return NULL;
+    }
+
+    uint64_t shared_identity = yep_shared_enabled ? _yep_shared_identity(modify_time, size) : 0;
+    struct yep_pack *pack = _yep_pack_index(file, base, size, true, shared_identity);
+    if(pack != NULL)
+        pack->modify_time = modify_time;
+    return pack;
+}
+
+struct yep_pack *yep_pack_open_memory(const void *data, size_t size, const char *name){
+    // embedded blobs often have no meaningful name
+    if(name == NULL)
+        name = "<memory>";
+
+    if(data == NULL){
+        yep_logf(yep_log_error,"Error: no data given for pack %s\n", name);
+        return NULL;
+    }
+    return _yep_pack_index(name, data, size, false, 0);
+}
+
+void yep_pack_close(struct yep_pack *pack){
+    if(pack == NULL)
+        return;
+
+    _yep_release(pack->base, pack->size, pack->mapped);
+    if(pack->loose_root != NULL)
+        yep_loose_watch_close(pack->loose_watch);
+    free(pack->loose_root);
+    free(pack->loose_times);
+    free(pack->region_buckets);
+    free(pack->region_hashes);
+    free(pack->region_names);
+    free(pack->regions);
+    if(pack->shared != NULL)
+        yep_shared_close(pack->shared);
+    else{
+        free(pack->buckets);
+        free(pack->hashes);
+        free(pack->entries);
+    }
+    free(pack->path);
+    free(pack);
+}
+
+bool yep_pack_is_stale(const struct yep_pack *pack){
+    if(pack->loose_root != NULL)
+        return yep_loose_watch_changed(pack->loose_watch);
+    if(!pack->mapped)
+        return false;
+
+    // packs are replaced by a rename, so the path always names a complete pack
+    SDL_PathInfo info;
+    if(!SDL_GetPathInfo(pack->path, &info))
+        return false;
+    return info.modify_time != pack->modify_time || info.size != pack->size;
+}
+
+const char *yep_pack_path(const struct yep_pack *pack){
+    return pack->path;
+}
+
+uint8_t yep_pack_version(const struct yep_pack *pack){
+    return pack->version;
+}
+
+uint32_t yep_pack_entry_count(const struct yep_pack *pack){
+    return pack->entry_count;
+}
+
+const struct yep_entry *yep_pack_entry(const struct yep_pack *pack, uint32_t index){
+    if(index >= pack->entry_count)
+        return NULL;
+    return &pack->entries[index];
+}
+
+int32_t yep_pack_find(const struct yep_pack *pack, const char *handle){
+    uint64_t hash = yep_hash_handle(handle);
+
+    uint32_t slot = (uint32_t)hash & pack->bucket_mask;
+    while(pack->buckets[slot] != UINT32_MAX){
+        uint32_t index = pack->buckets[slot];
+        if(pack->hashes[index] == hash && strcmp(pack->entries[index].name, handle) == 0)
+            return (int32_t)index;
+        slot = (slot + 1) & pack->bucket_mask;
     }
 
-    // assuming we didnt fail, we have the header data
-    // printf("Resource:\n");
-    // printf("    Name: %s\n", name);
-    // printf("    Offset: %d\n", offset);
-    // printf("    Size: %d\n", size);
-    // printf("    Uncompressed size: %d\n", uncompressed_size);
-    // printf("    Compression type: %d\n", compression_type);
-    // printf("    Data type: %d\n", data_type);
+    return -1;
+}
 
-    // seek to the offset
-    fseek(yep_file, offset, SEEK_SET);
+int32_t yep_pack_find_hash(const struct yep_pack *pack, uint64_t hash){
+    uint32_t slot = (uint32_t)hash & pack->bucket_mask;
+    while(pack->buckets[slot] != UINT32_MAX){
+        uint32_t index = pack->buckets[slot];
+        if(pack->hashes[index] == hash)
+            return (int32_t)index;
+        slot = (slot + 1) & pack->bucket_mask;
+    }
 
-    // read the data
-    char *data = malloc(size + 1); // null terminator
-    fread(data, sizeof(char), size, yep_file);
+    return -1;
+}
+
+uint64_t yep_pack_fingerprint(const struct yep_pack *pack){
+    return pack->fingerprint;
+}
+
+// post processing of an extracted payload that depends on its data type
+static struct yep_data_info _yep_finish_extract(const struct yep_entry *entry, char *data, size_t size){
+    if(entry->data_type == YEP_DATATYPE_ANIMATION && !yep_animation_resolve(data, size)){
+        yep_logf(yep_log_warning,"Could not resolve animation frames of %s\n", entry->name);
+        free(data);
+        return (struct yep_data_info){.data = NULL, .size = 0};
+    }
 
-    // null terminate the data
-    if(compression_type == YEP_COMPRESSION_NONE)
-        data[size] = '\0';
+    return (struct yep_data_info){.data = data, .size = size};
+}
 
-    // printf("DATA VALUE LITERAL: %s\n", data);
+// decodes a stored entry of a pack file into the heap
+static struct yep_data_info _yep_decode_entry(const struct yep_pack *pack, const struct yep_entry *entry){
+    const char *stored = (const char *)pack->base + entry->offset;
 
-    // if the data is compressed, decompress it
-    if(compression_type == YEP_COMPRESSION_ZLIB){
+    if(entry->compression_type == YEP_COMPRESSION_ZLIB){
         char *decompressed_data;
-        if(decompress_data(data, size, &decompressed_data, uncompressed_size) != 0){
+        if(decompress_data(stored, entry->size, &decompressed_data, entry->uncompressed_size) != 0){
             yep_logf(yep_log_warning,"!!!Error decompressing data!!!\n");
             return (struct yep_data_info){.data = NULL, .size = 0};
         }
 
-        // printf("Decompressed %s from %d bytes to %d bytes\n", handle, size, uncompressed_size);
-        // printf("    Compression ratio: %f\n", (float)uncompressed_size / (float)size);
-        // printf("    Compression percentage: %f%%\n", ((float)uncompressed_size / (float)size) * 100.0f);
-        // printf("    Compression savings: %d bytes\n", uncompressed_size - size);
-        // printf("    DATA: %s\n", decompressed_data);
+        return _yep_finish_extract(entry, decompressed_data, entry->uncompressed_size);
+    }
 
-        // free the original data
-        free(data);
+    if(entry->compression_type == YEP_COMPRESSION_FILTERED_ZLIB){
+        char *unfiltered_data;
+        if(yep_filter_decompress(stored, entry->size, &unfiltered_data, entry->uncompressed_size) != 0){
+            yep_logf(yep_log_warning,"!!!Error decompressing filtered data!!!\n");
+            return (struct yep_data_info){.data = NULL, .size = 0};
+        }
+
+        return (struct yep_data_info){.data = unfiltered_data, .size = entry->uncompressed_size};
+    }
+
+    if(entry->compression_type == YEP_COMPRESSION_LPC){
+        char *decoded_data;
+        if(yep_lpc_decompress(stored, entry->size, &decoded_data, entry->uncompressed_size) != 0){
+            yep_logf(yep_log_warning,"!!!Error decoding pcm data!!!\n");
+            return (struct yep_data_info){.data = NULL, .size = 0};
+        }
+
+        return (struct yep_data_info){.data = decoded_data, .size = entry->uncompressed_size};
+    }
+
+    if(entry->compression_type != YEP_COMPRESSION_NONE){
+        yep_logf(yep_log_warning,"Unknown compression type %d for %s\n", entry->compression_type, entry->name);
+        return (struct yep_data_info){.data = NULL, .size = 0};
+    }
+
+    // uncompressed data is null terminated for convenience
+    char *data = malloc(entry->size + 1);
+    memcpy(data, stored, entry->size);
+    data[entry->size] = '\0';
+
+    return _yep_finish_extract(entry, data, entry->size);
+}
+
+struct yep_data_info yep_pack_extract(const struct yep_pack *pack, uint32_t index){
+    if(index >= pack->entry_count)
+        return (struct yep_data_info){.data = NULL, .size = 0};
+
+    const struct yep_entry *entry = &pack->entries[index];
+
+    // mounted directories read the file as it is now, edits show up without reopening
+    if(pack->loose_root != NULL){
+        size_t size;
+        char *data = yep_loose_read(pack->loose_root, entry->name, &size);
+        return (struct yep_data_info){.data = data, .size = data != NULL ? size : 0};
+    }
+
+    if(pack->shared == NULL || entry->compression_type == YEP_COMPRESSION_NONE)
+        return _yep_decode_entry(pack, entry);
+
+    // another process may have decoded it already, the caller still gets its own copy
+    size_t size;
+    const void *cached = yep_shared_cache_get(pack->shared, index, &size);
+    if(cached != NULL){
+        char *data = malloc(size ? size : 1);
+        memcpy(data, cached, size);
+        return (struct yep_data_info){.data = data, .size = size};
+    }
+
+    struct yep_data_info info = _yep_decode_entry(pack, entry);
+    if(info.data != NULL)
+        yep_shared_cache_put(pack->shared, index, info.data, info.size);
+    return info;
+}
+
+struct yep_data_info yep_extract_by_id(const struct yep_pack *pack, uint32_t id, uint64_t hash){
+    // the id is only a hint, the hash decides if it still points at the right entry
+    if(id < pack->entry_count && pack->hashes[id] == hash)
+        return yep_pack_extract(pack, id);
+
+    int32_t index = yep_pack_find_hash(pack, hash);
+    if(index < 0){
+        yep_logf(yep_log_warning,"No entry with hash 0x%016" PRIx64 " in %s\n", hash, pack->path);
+        return (struct yep_data_info){.data = NULL, .size = 0};
+    }
+
+    yep_logf(yep_log_debug,"Id %u is stale for %s, regenerate its header\n", id, pack->entries[index].name);
+    return yep_pack_extract(pack, (uint32_t)index);
+}
+
+bool yep_pack_find_region(const struct yep_pack *pack, const char *handle, struct yep_atlas_region *out){
+    if(pack->region_count == 0)
+        return false;
+
+    uint64_t hash = yep_hash_handle(handle);
+
+    uint32_t slot = (uint32_t)hash & pack->region_mask;
+    while(pack->region_buckets[slot] != UINT32_MAX){
+        uint32_t index = pack->region_buckets[slot];
+        if(pack->region_hashes[index] == hash && strcmp(pack->region_names[index], handle) == 0){
+            *out = pack->regions[index];
+            return true;
+        }
+        slot = (slot + 1) & pack->region_mask;
+    }
+
+    return false;
+}
+
+const void *yep_pack_view(const struct yep_pack *pack, uint32_t index, size_t *size){
+    if(index >= pack->entry_count || pack->base == NULL)
+        return NULL;
+
+    const struct yep_entry *entry = &pack->entries[index];
+    if(entry->compression_type == YEP_COMPRESSION_NONE){
+        *size = entry->size;
+        return pack->base + entry->offset;
+    }
+    if(pack->shared == NULL)
+        return NULL;
+
+    // compressed entries are decoded once into shared memory and borrowed from there
+    const void *cached = yep_shared_cache_get(pack->shared, index, size);
+    if(cached != NULL)
+        return cached;
+
+    struct yep_data_info info = _yep_decode_entry(pack, entry);
+    if(info.data == NULL)
+        return NULL;
+
+    cached = yep_shared_cache_put(pack->shared, index, info.data, info.size);
+    free(info.data);
+    if(cached != NULL){
+        *size = info.size;
+        return cached;
+    }
+
+    // lost the race to another process (or the cache is full)
+    return yep_shared_cache_get(pack->shared, index, size);
+}
+
+/*
+    ================================= HOT RELOAD =================================
+*/
 
-        // set the data to the decompressed data
-        data = decompressed_data;
-        size = uncompressed_size;
+// stored bytes are deterministic for the same input (and copied as is by the pack cache), so equal bytes mean an unchanged entry
+static bool _yep_entry_unchanged(const struct yep_pack *old_pack, uint32_t old_index, const struct yep_pack *new_pack, uint32_t new_index){
+    const struct yep_entry *old_entry = &old_pack->entries[old_index];
+    const struct yep_entry *new_entry = &new_pack->entries[new_index];
+
+    if(old_entry->size != new_entry->size || old_entry->uncompressed_size != new_entry->uncompressed_size ||
+       old_entry->compression_type != new_entry->compression_type || old_entry->data_type != new_entry->data_type)
+        return false;
+
+    // mounted directories have no bytes in memory, the scan times stand in for them
+    if(old_pack->loose_root != NULL || new_pack->loose_root != NULL){
+        return old_pack->loose_root != NULL && new_pack->loose_root != NULL &&
+               old_pack->loose_times[old_index] == new_pack->loose_times[new_index];
+    }
+
+    return memcmp(old_pack->base + old_entry->offset, new_pack->base + new_entry->offset, new_entry->size) == 0;
+}
+
+uint32_t yep_pack_diff(const struct yep_pack *old_pack, const struct yep_pack *new_pack, struct yep_pack_change **changes){
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    *changes = NULL;
+
+    bool *matched = calloc(old_pack->entry_count ? old_pack->entry_count : 1, sizeof(bool));
+
+    for(uint32_t i = 0; i < new_pack->entry_count; i++){
+        int32_t old_index = yep_pack_find(old_pack, new_pack->entries[i].name);
+        if(old_index >= 0){
+            matched[old_index] = true;
+            if(_yep_entry_unchanged(old_pack, (uint32_t)old_index, new_pack, i))
+                continue;
+        }
+
+        if(count == capacity){
+            capacity = capacity ? capacity * 2 : 16;
+            *changes = realloc(*changes, capacity * sizeof(struct yep_pack_change));
+        }
+        (*changes)[count++] = (struct yep_pack_change){
+            .kind = old_index >= 0 ? YEP_CHANGE_MODIFIED : YEP_CHANGE_ADDED,
+            .id = i,
+            .old_id = old_index >= 0 ? (uint32_t)old_index : UINT32_MAX,
+            .hash = new_pack->hashes[i],
+            .name = new_pack->entries[i].name,
+        };
+    }
+
+    for(uint32_t i = 0; i < old_pack->entry_count; i++){
+        if(matched[i])
+            continue;
+
+        if(count == capacity){
+            capacity = capacity ? capacity * 2 : 16;
+            *changes = realloc(*changes, capacity * sizeof(struct yep_pack_change));
+        }
+        (*changes)[count++] = (struct yep_pack_change){
+            .kind = YEP_CHANGE_REMOVED,
+            .id = UINT32_MAX,
+            .old_id = i,
+            .hash = old_pack->hashes[i],
+            .name = old_pack->entries[i].name,
+        };
+    }
+
+    free(matched);
+    return count;
+}
+
+bool yep_pack_reload(struct yep_pack **pack, yep_reload_fn callback, void *userdata){
+    if(!yep_pack_is_stale(*pack))
+        return false;
+
+    struct yep_pack *new_pack = yep_pack_open((*pack)->path);
+    if(new_pack == NULL){
+        // keep serving the old contents, the next check tries again
+        yep_logf(yep_log_warning,"Could not reopen %s, keeping the previous version\n", (*pack)->path);
+        return false;
+    }
+
+    struct yep_pack_change *changes;
+    uint32_t count = yep_pack_diff(*pack, new_pack, &changes);
+    yep_logf(yep_log_debug,"Reloaded %s, %u entries changed\n", new_pack->path, count);
+
+    // the old pack stays open during the callback, removed names point into it
+    if(callback != NULL && count > 0)
+        callback(new_pack, changes, count, userdata);
+
+    free(changes);
+    yep_pack_close(*pack);
+    *pack = new_pack;
+    return true;
+}
+
+/*
+    ============================= LEGACY FILE API ================================
+
+    These keep the most recently used pack open (see the notes in libyep.h)
+*/
+
+// holds the reference to the currently open yep file
+static struct yep_pack *yep_current_pack = NULL;
+
+void _yep_close_file(){
+    yep_pack_close(yep_current_pack);
+    yep_current_pack = NULL;
+}
+
+// the legacy API must not keep serving file from where it was before a registration
+static void _yep_drop_current(const char *file){
+    if(yep_current_pack != NULL && strcmp(yep_current_pack->path, file) == 0)
+        _yep_close_file();
+}
+
+static yep_reload_fn yep_reload_callback = NULL;
+static void *yep_reload_userdata = NULL;
+
+void yep_set_reload_callback(yep_reload_fn callback, void *userdata){
+    yep_reload_callback = callback;
+    yep_reload_userdata = userdata;
+}
+
+bool yep_refresh_packs(void){
+    if(yep_current_pack == NULL || !yep_pack_is_stale(yep_current_pack))
+        return false;
+
+    // without a callback nobody needs the diff, so it is reopened lazily by the next extract
+    if(yep_reload_callback == NULL){
+        yep_logf(yep_log_debug,"%s changed on disk, reopening it\n", yep_current_pack->path);
+        _yep_close_file();
+        return true;
+    }
+
+    return yep_pack_reload(&yep_current_pack, yep_reload_callback, yep_reload_userdata);
+}
+
+bool _yep_open_file(const char *file){
+    // if we already have this file open, don't open it again
+    if(yep_current_pack != NULL && strcmp(yep_current_pack->path, file) == 0){
+        return true;
+    }
+
+    // only one file is kept open at a time
+    _yep_close_file();
+
+    yep_current_pack = yep_pack_open(file);
+    return yep_current_pack != NULL;
+}
+
+struct yep_data_info yep_extract_data(const char *file, const char *handle){
+    if(!_yep_open_file(file)){
+        yep_logf(yep_log_warning,"Error opening yep file %s\n", file);
+        return (struct yep_data_info){.data = NULL, .size = 0};
+    }
+
+    // try to get our header
+    int32_t index = yep_pack_find(yep_current_pack, handle);
+    if(index < 0){
+        yep_logf(yep_log_warning,"Handle \"%s\" does not exist in yep file %s\n", handle, file);
+        return (struct yep_data_info){.data = NULL, .size = 0};
+    }
+
+    return yep_pack_extract(yep_current_pack, (uint32_t)index);
+}
+
+bool yep_item_exists(const char* file, const char* handle) {
+    // open the file
+    if(!_yep_open_file(file)){
+        yep_logf(yep_log_warning,"Error opening yep file %s\n", file);
+        return false;
     }
 
-    // create return data
-    struct yep_data_info info;
-    info.data = data;
-    info.size = size;
+    return yep_pack_find(yep_current_pack, handle) >= 0;
+}
 
-    // return the data
-    return info;
+/*
+    Frees a pack list node and any animation frames folded into it
+*/
+static void _yep_free_node(struct yep_header_node *node){
+    struct yep_header_node *frame = node->frames;
+    while(frame != NULL){
+        struct yep_header_node *next = frame->next;
+        free(frame->fullpath);
+        free(frame);
+        frame = next;
+    }
+    free(node->payload);
+    free(node->fullpath);
+    free(node);
 }
 
 void yep_initialize(){
@@ -385,17 +1144,18 @@ void yep_shutdown(){
         struct yep_header_node *itr = yep_pack_list.head;
         while(itr != NULL){
             struct yep_header_node *next = itr->next;
-            free(itr->fullpath);
-            free(itr);
+            _yep_free_node(itr);
             itr = next;
         }
+        yep_pack_list.head = NULL;
+        yep_pack_list.entry_count = 0;
     }
 
     yep_logf(yep_log_info,"Shutting down yep subsystem...\n");
-}
 
-// forward decl
-void _yep_walk_directory_v2(char *dir_path);
+    // hand anything still queued to the sink before we return
+    yep_log_stop_async();
+}
 
 // Function to normalize path separators to forward slashes
 static void normalize_path_separators(char *path) {
@@ -409,22 +1169,20 @@ static void normalize_path_separators(char *path) {
 // Global variable to store the original root directory path for relative path calculation
 static char *yep_pack_root_path = NULL;
 
-static SDL_EnumerationResult SDLCALL _recurse_dir_callback(void *userdata, const char *dirname, const char *fname) {
+// every file and directory the walk visits, only collected if a depfile was asked for
+static struct yep_depfile *yep_pack_deps = NULL;
+
+static void _recurse_dir_callback(const char *path, const SDL_PathInfo *path_info, void *userdata) {
     (void)userdata; // unused
     
     char full_path[4096];
-    snprintf(full_path, sizeof(full_path), "%s%s", dirname, fname);
+    snprintf(full_path, sizeof(full_path), "%s", path);
     
     // Normalize path separators in full_path for consistent comparison
     normalize_path_separators(full_path);
 
     // Check if path is a file
-    SDL_PathInfo path_info;
-    if (!yep_get_path_info(full_path, &path_info)) {
-        yep_logf(yep_log_error,"yep traverse: Error getting path info for file %s\n", full_path);
-        return SDL_ENUM_CONTINUE;
-    }
-    if (path_info.type == SDL_PATHTYPE_FILE) {
+    if (path_info->type == SDL_PATHTYPE_FILE) {
         // Calculate the relative path from the original root directory
         char *relative_path;
         if (yep_pack_root_path != NULL) {
@@ -444,11 +1202,11 @@ static SDL_EnumerationResult SDLCALL _recurse_dir_callback(void *userdata, const
                 }
             } else {
                 yep_logf(yep_log_error,"Error: file %s is not within the root directory %s\n", full_path, normalized_root);
-                return SDL_ENUM_CONTINUE;
+                return;
             }
         } else {
-            // Fallback to old behavior if root path is not set
-            relative_path = full_path + strlen(dirname) + 1;
+            // Fallback if root path is not set
+            relative_path = full_path;
         }        // Convert backslashes to forward slashes for consistent storage
         char normalized_relative_path[256];
         strncpy(normalized_relative_path, relative_path, sizeof(normalized_relative_path) - 1);
@@ -467,7 +1225,7 @@ static SDL_EnumerationResult SDLCALL _recurse_dir_callback(void *userdata, const
         }        // if the relative path plus its null terminator is greater than 64 bytes, we reject packing this and alert the user
         if(strlen(final_relative_path) + 1 > 64){
             yep_logf(yep_log_error,"Error: file %s has a relative path that is too long to pack into a yep file\n", full_path);
-            return SDL_ENUM_CONTINUE;
+            return;
         }
 
         // add a yep header node with the relative path
@@ -478,11 +1236,16 @@ static SDL_EnumerationResult SDLCALL _recurse_dir_callback(void *userdata, const
 
         // set the full path
         node->fullpath = strdup(full_path);
+        node->frames = NULL;
+        node->payload = NULL;
 
         // set the name
         sprintf(node->name, "%s", final_relative_path);
         node->name[strlen(final_relative_path)] = '\0'; // ensure null termination
 
+        if(yep_pack_deps != NULL)
+            yep_depfile_add(yep_pack_deps, full_path);
+
         // add the node to the LL
         node->next = yep_pack_list.head;
         yep_pack_list.head = node;
@@ -490,22 +1253,24 @@ static SDL_EnumerationResult SDLCALL _recurse_dir_callback(void *userdata, const
         // increment the entry count
         yep_pack_list.entry_count++;
     }
-    else if (path_info.type == SDL_PATHTYPE_DIRECTORY) {
-        // If it's a directory, recurse into it
-        _yep_walk_directory_v2(full_path);
+    else if (path_info->type == SDL_PATHTYPE_DIRECTORY) {
+        // the walk visits its contents next, a directory changes when files are added or removed
+        if(yep_pack_deps != NULL)
+            yep_depfile_add(yep_pack_deps, full_path);
     } else {
         yep_logf(yep_log_debug,"yep traverse: Skipping non-file path %s\n", full_path);
     }
-
-    return SDL_ENUM_CONTINUE;
 }
 
 /*
     Recursively walk the target pack directory and create a LL of files to be packed
+
+    The tree comes out of the pack run's stat cache, so a directory the up-to-date check
+    already swept is not listed or statted again
 */
 void _yep_walk_directory_v2(char *dir_path) {
     SDL_PathInfo path_info;
-    if(!yep_get_path_info(dir_path, &path_info)) {
+    if(!yep_stat_cache_get(yep_pack_stats, dir_path, &path_info)) {
         yep_logf(yep_log_error,"yep traverse: Error getting path info for directory %s\n", dir_path);
         return;
     }
@@ -516,7 +1281,11 @@ void _yep_walk_directory_v2(char *dir_path) {
         return;
     }
 
-    SDL_EnumerateDirectory(dir_path, _recurse_dir_callback, NULL);
+    // a directory changes when files are added or removed, which is what picks up new files
+    if(yep_pack_deps != NULL)
+        yep_depfile_add(yep_pack_deps, dir_path);
+
+    yep_stat_cache_walk(yep_pack_stats, dir_path, _recurse_dir_callback, NULL);
 }
 
 /*
@@ -568,66 +1337,375 @@ void update_header(FILE *pack_file, int entry_index, uint32_t offset, uint32_t s
     fwrite(&data_type, sizeof(uint8_t), 1, pack_file);
 }
 
-void write_pack_file(FILE *pack_file) {
-    // holds the start of the header for our current entry
-    uint32_t data_start = 3 + (yep_pack_list.entry_count * YEP_HEADER_SIZE_BYTES);
+/*
+    Pack stages, each may replace a source file with a preprocessed payload
+*/
+static void _yep_apply_stages(const struct yep_header_node *node, char **data, uint32_t *size, uint8_t *data_type){
+    if(yep_options.decode_images && yep_is_image_path(node->name)){
+        char *image;
+        size_t image_size;
+        if(yep_image_encode(*data, *size, yep_options.image_mips, &image, &image_size)){
+            yep_logf(yep_log_debug,"Decoded image %s (%u -> %zu bytes)\n", node->name, *size, image_size);
+            free(*data);
+            *data = image;
+            *size = (uint32_t)image_size;
+            *data_type = (uint8_t)YEP_DATATYPE_IMAGE;
+        }
+    }
 
-    // holds the end of the data pack
-    uint32_t data_end = data_start;
+    if(yep_options.decode_audio && yep_is_audio_path(node->name)){
+        char *audio;
+        size_t audio_size;
+        if(yep_audio_encode(*data, *size, &audio, &audio_size)){
+            yep_logf(yep_log_debug,"Decoded audio %s (%u -> %zu bytes)\n", node->name, *size, audio_size);
+            free(*data);
+            *data = audio;
+            *size = (uint32_t)audio_size;
+            *data_type = (uint8_t)YEP_DATATYPE_PCM;
+        }
+    }
 
-    // holds the current entry
-    int current_entry = 0;
+    if(yep_options.compile_lua && yep_is_lua_path(node->name)){
+        char *bytecode;
+        size_t bytecode_size;
+        if(yep_lua_compile(node->name, *data, *size, !yep_options.lua_debug_info, &bytecode, &bytecode_size)){
+            yep_logf(yep_log_debug,"Compiled script %s (%u -> %zu bytes)\n", node->name, *size, bytecode_size);
+            free(*data);
+            *data = bytecode;
+            *size = (uint32_t)bytecode_size;
+            *data_type = (uint8_t)YEP_DATATYPE_LUA_BYTECODE;
+        }
+    }
+}
 
-    printf("\n"); // start the progress bar on a new line
+/*
+    Reads a source file and runs it through the pack stages, false if it cannot be read
+*/
+static bool _yep_load_file(struct yep_header_node *node, char **data, uint32_t *size, uint8_t *data_type){
+    // generated by an earlier stage, hand it over as-is
+    if(node->payload != NULL){
+        *data = node->payload;
+        *size = node->payload_size;
+        *data_type = node->data_type;
+        node->payload = NULL;
+        return true;
+    }
 
-    struct yep_header_node *itr = yep_pack_list.head;
-    while(itr != NULL){
+    // the file may have been removed since the walk (yep watch packs while files are edited)
+    FILE *file_to_write = fopen(node->fullpath, "rb");
+    if (file_to_write == NULL) {
+        yep_logf(yep_log_error,"Error opening yep file to pack yep: %s\n", node->fullpath);
+        return false;
+    }
 
-        FILE *file_to_write = fopen(itr->fullpath, "rb");
-        if (file_to_write == NULL) {
-            yep_logf(yep_log_error,"Error opening yep file to pack yep: %s\n", itr->fullpath);
-            exit(1);
-        }
+    *size = get_file_size(file_to_write);
+    *data = read_file_data(file_to_write, *size);
+    fclose(file_to_write);
+
+    *data_type = (uint8_t)YEP_DATATYPE_MISC;
+    _yep_apply_stages(node, data, size, data_type);
+    return true;
+}
 
-        uint32_t data_size = get_file_size(file_to_write);
-        uint32_t uncompressed_size = data_size;
-        char *data = read_file_data(file_to_write, data_size);
-        fclose(file_to_write);
+/*
+    Builds the payload of one entry, bundling the frames of animation entries
+*/
+static bool _yep_load_payload(struct yep_header_node *node, char **data, uint32_t *size, uint8_t *data_type){
+    if(node->frames == NULL)
+        return _yep_load_file(node, data, size, data_type);
 
-        // somewhere here is where we would perform our compression or
-        // manipulation of the data depending on its format
-        uint8_t compression_type = (uint8_t)YEP_COMPRESSION_NONE;
-        uint8_t data_type = (uint8_t)YEP_DATATYPE_MISC;
+    uint32_t frame_count = 0;
+    for(const struct yep_header_node *frame = node->frames; frame != NULL; frame = frame->next)
+        frame_count++;
 
-        if(
-            data_size > 256
-            // here is where we can && exclusion conditions, like bytecode
-        ){
-            compression_type = (uint8_t)YEP_COMPRESSION_ZLIB;
-        }
+    char **frames = malloc(frame_count * sizeof(char *));
+    uint32_t *sizes = malloc(frame_count * sizeof(uint32_t));
+    uint8_t *types = malloc(frame_count * sizeof(uint8_t));
 
-        // compress this data with zlib
-        if(compression_type == YEP_COMPRESSION_ZLIB){
-            char *compressed_data;
-            size_t compressed_size;
-            compress_data(data, data_size, &compressed_data, &compressed_size);
+    uint32_t loaded = 0;
+    for(struct yep_header_node *frame = node->frames; frame != NULL; frame = frame->next, loaded++){
+        if(!_yep_load_file(frame, &frames[loaded], &sizes[loaded], &types[loaded]))
+            break;
+    }
+
+    size_t animation_size;
+    bool ok = loaded == frame_count;
+    if(ok && !yep_animation_build(frame_count, frames, sizes, types, yep_options.animation_delta, data, &animation_size)){
+        yep_logf(yep_log_error,"Error: animation %s is too large to pack\n", node->name);
+        ok = false;
+    }
+    if(ok){
+        *size = (uint32_t)animation_size;
+        *data_type = (uint8_t)YEP_DATATYPE_ANIMATION;
+        yep_logf(yep_log_debug,"Bundled %u frames into %s (%u bytes)\n", frame_count, node->name, *size);
+    }
+
+    for(uint32_t i = 0; i < loaded; i++)
+        free(frames[i]);
+    free(frames);
+    free(sizes);
+    free(types);
+    return ok;
+}
+
+// runs the stages and picks a compression for one entry, the data is allocated into the heap
+static bool _yep_encode_entry(struct yep_header_node *node, char **out_data, uint32_t *out_size, uint32_t *out_uncompressed_size,
+                              uint8_t *out_compression_type, uint8_t *out_data_type, Uint64 *out_compress_ticks){
+    // turn the source file(s) into the payload we store, depending on their format
+    char *data;
+    uint32_t data_size;
+    uint8_t data_type;
+    if(!_yep_load_payload(node, &data, &data_size, &data_type))
+        return false;
+    uint32_t uncompressed_size = data_size;
+
+    uint8_t compression_type = (uint8_t)YEP_COMPRESSION_NONE;
+
+    if(
+        data_size > 256
+        // here is where we can && exclusion conditions, like bytecode
+        && data_type != YEP_DATATYPE_LUA_BYTECODE
+        && data_type != YEP_DATATYPE_ATLAS
+    ){
+        compression_type = (uint8_t)YEP_COMPRESSION_ZLIB;
+    }
+
+    Uint64 compress_ticks = 0;
 
-            // printf("Compressed %s from %d bytes to %d bytes\n", itr->fullpath, data_size, compressed_size);
-            // printf("    Compression ratio: %f\n", (float)compressed_size / (float)data_size);
-            // printf("    Compression percentage: %f%%\n", ((float)compressed_size / (float)data_size) * 100.0f);
-            // printf("    Compression savings: %d bytes\n", data_size - compressed_size);
-            // printf("    DATA: %s\n", compressed_data);
+    // pcm gets its own codec, falling back to zlib if it does not help
+    if(compression_type == YEP_COMPRESSION_ZLIB && data_type == YEP_DATATYPE_PCM){
+        char *encoded_data;
+        size_t encoded_size;
 
-            // free the original data
+        Uint64 compress_start = SDL_GetPerformanceCounter();
+        bool encoded = yep_lpc_compress(data, data_size, &encoded_data, &encoded_size);
+        compress_ticks = SDL_GetPerformanceCounter() - compress_start;
+
+        if(encoded && encoded_size < data_size){
             free(data);
+            data = encoded_data;
+            data_size = encoded_size;
+            compression_type = (uint8_t)YEP_COMPRESSION_LPC;
+        }
+        else if(encoded){
+            free(encoded_data);
+        }
+    }
+
+    // set once data already holds the zlib stream
+    bool deflated = false;
+
+    // raw pixels usually deflate far better once each row is predicted from its neighbours,
+    // noisy ones do not, so the filtered stream has to beat plain zlib and the raw pixels
+    if(compression_type == YEP_COMPRESSION_ZLIB && data_type == YEP_DATATYPE_IMAGE){
+        char *filtered_data;
+        size_t filtered_size;
 
-            // set the data to the compressed data
+        Uint64 compress_start = SDL_GetPerformanceCounter();
+        bool filtered = yep_filter_compress(data, data_size, &filtered_data, &filtered_size);
+        compress_ticks = SDL_GetPerformanceCounter() - compress_start;
+
+        char *compressed_data;
+        size_t compressed_size;
+
+        compress_start = SDL_GetPerformanceCounter();
+        bool compressed = compress_data(data, data_size, &compressed_data, &compressed_size) == 0;
+        compress_ticks += SDL_GetPerformanceCounter() - compress_start;
+
+        if(filtered && (!compressed || filtered_size < compressed_size) && filtered_size < data_size){
+            free(data);
+            data = filtered_data;
+            data_size = filtered_size;
+            compression_type = (uint8_t)YEP_COMPRESSION_FILTERED_ZLIB;
+            filtered = false;
+        }
+        else if(compressed && compressed_size < data_size){
+            free(data);
             data = compressed_data;
             data_size = compressed_size;
+            deflated = true;
+            compressed = false;
+        }
+        else {
+            compression_type = (uint8_t)YEP_COMPRESSION_NONE;
+        }
+
+        // whichever encoding lost
+        if(filtered)
+            free(filtered_data);
+        if(compressed)
+            free(compressed_data);
+    }
+
+    // compress this data with zlib
+    if(compression_type == YEP_COMPRESSION_ZLIB && !deflated){
+        char *compressed_data;
+        size_t compressed_size;
+
+        Uint64 compress_start = SDL_GetPerformanceCounter();
+        compress_data(data, data_size, &compressed_data, &compressed_size);
+        compress_ticks += SDL_GetPerformanceCounter() - compress_start;
+
+        // free the original data
+        free(data);
+
+        // set the data to the compressed data
+        data = compressed_data;
+        data_size = compressed_size;
+    }
+
+
+    *out_data = data;
+    *out_size = data_size;
+    *out_uncompressed_size = uncompressed_size;
+    *out_compression_type = compression_type;
+    *out_data_type = data_type;
+    *out_compress_ticks = compress_ticks;
+    return true;
+}
+
+// plain files at least this large are checked for being incompressible, see _yep_store_raw()
+#define YEP_RAW_MIN_SIZE (256 * 1024)
+#define YEP_RAW_SAMPLE_SIZE (64 * 1024)
+
+// large uncompressed entries start on a file system block, so they can be shared with their source (reflinks)
+#define YEP_RAW_ALIGNMENT 4096
+
+static bool _yep_stages_apply(const struct yep_header_node *node){
+    return (yep_options.decode_images && yep_is_image_path(node->name)) ||
+           (yep_options.decode_audio && yep_is_audio_path(node->name)) ||
+           (yep_options.compile_lua && yep_is_lua_path(node->name));
+}
+
+/*
+    Large plain files that deflate does not shrink (already compressed media) are stored as
+    they are. Only a sample is compressed to find out, and the file is then copied into the
+    pack kernel-side by yep_copy_range() instead of being read into memory.
+
+    Returns the open source file on success
+*/
+static FILE *_yep_store_raw(const struct yep_header_node *node, uint32_t *out_size, Uint64 *out_compress_ticks){
+    if(node->payload != NULL || node->frames != NULL || _yep_stages_apply(node))
+        return NULL;
+
+    // a missing file is reported by _yep_load_file()
+    FILE *file = fopen(node->fullpath, "rb");
+    if(file == NULL)
+        return NULL;
+
+    uint32_t size = get_file_size(file);
+    if(size < YEP_RAW_MIN_SIZE){
+        fclose(file);
+        return NULL;
+    }
+
+    char *sample = read_file_data(file, YEP_RAW_SAMPLE_SIZE);
+    char *compressed;
+    size_t compressed_size;
+
+    Uint64 compress_start = SDL_GetPerformanceCounter();
+    int res = compress_data(sample, YEP_RAW_SAMPLE_SIZE, &compressed, &compressed_size);
+    *out_compress_ticks = SDL_GetPerformanceCounter() - compress_start;
+    free(sample);
+
+    // compress_data() cleans up after itself, leave the file to the regular path
+    if(res != 0){
+        fclose(file);
+        return NULL;
+    }
+    free(compressed);
+
+    // saving less than 5% is not worth inflating on every load
+    if(compressed_size * 100 < (size_t)YEP_RAW_SAMPLE_SIZE * 95){
+        fclose(file);
+        return NULL;
+    }
+
+    yep_logf(yep_log_debug,"Storing %s uncompressed, it does not deflate\n", node->name);
+    *out_size = size;
+    return file;
+}
+
+/*
+    Writes every entry after the header table and closes pack_file. Returns false if the pack
+    is incomplete, report_ok is false if only the report could not be written
+*/
+bool write_pack_file(FILE *pack_file, const char *output_name, struct yep_cache *cache, bool *report_ok) {
+    // holds the start of the header for our current entry
+    uint32_t data_start = 3 + (yep_pack_list.entry_count * YEP_HEADER_SIZE_BYTES);
+
+    // holds the end of the data pack
+    uint32_t data_end = data_start;
+
+    // holds the current entry
+    int current_entry = 0;
+
+    // progress reporting state
+    struct yep_pack_progress progress = {
+        .entries_done = 0,
+        .entries_total = (uint32_t)yep_pack_list.entry_count,
+        .bytes_in = 0,
+        .bytes_out = 0,
+        .current = NULL,
+    };
+    Uint64 last_progress_ticks = 0;
+
+    // only collect statistics if someone asked for them
+    struct yep_report *report = yep_options.report_path != NULL ? yep_report_create() : NULL;
+    Uint64 counter_frequency = SDL_GetPerformanceFrequency();
+
+    bool ok = true;
+    struct yep_header_node *itr = yep_pack_list.head;
+    while(itr != NULL){
+
+        char *data = NULL;
+        uint32_t data_size;
+        uint32_t uncompressed_size;
+        uint8_t compression_type;
+        uint8_t data_type;
+        Uint64 compress_ticks = 0;
+
+        // stored bytes that already sit in a file are copied file to file instead of through data
+        FILE *source = NULL;
+        uint64_t source_offset = 0;
+        bool owns_source = false;
+
+        // unchanged sources are copied as stored from the previous pack
+        struct yep_cache_entry cached;
+        if(cache != NULL && yep_cache_lookup(cache, itr, &cached)){
+            source = cached.source;
+            source_offset = cached.offset;
+            data_size = cached.size;
+            uncompressed_size = cached.uncompressed_size;
+            compression_type = cached.compression_type;
+            data_type = cached.data_type;
+        }
+        else if((source = _yep_store_raw(itr, &data_size, &compress_ticks)) != NULL){
+            owns_source = true;
+            uncompressed_size = data_size;
+            compression_type = (uint8_t)YEP_COMPRESSION_NONE;
+            data_type = (uint8_t)YEP_DATATYPE_MISC;
+        }
+        else if(!_yep_encode_entry(itr, &data, &data_size, &uncompressed_size, &compression_type, &data_type, &compress_ticks)){
+            ok = false;
+            break;
+        }
+
+        // uncompressed data can be viewed in place, so keep it aligned (the gap reads back as zeros)
+        if(compression_type == YEP_COMPRESSION_NONE){
+            uint32_t alignment = data_size >= YEP_RAW_MIN_SIZE ? YEP_RAW_ALIGNMENT : YEP_DATA_ALIGNMENT;
+            data_end = (data_end + alignment - 1) & ~(alignment - 1);
         }
 
         // write the actual data from our data file to the pack file
-        write_data_to_pack(pack_file, data_end, data, data_size);
+        if(source != NULL){
+            ok = yep_copy_range(pack_file, data_end, source, source_offset, data_size);
+            if(owns_source)
+                fclose(source);
+        }
+        else {
+            write_data_to_pack(pack_file, data_end, data, data_size);
+        }
 
         // update the pack file header with the location and information about the data we wrote
         update_header(pack_file, current_entry, data_end, data_size, compression_type, uncompressed_size, data_type);
@@ -635,51 +1713,430 @@ void write_pack_file(FILE *pack_file) {
         // free the data
         free(data);
 
+        if(!ok || ferror(pack_file)){
+            yep_logf(yep_log_error,"Error writing %s into the pack\n", itr->name);
+            ok = false;
+            break;
+        }
+
+        if(report != NULL){
+            uint64_t compress_ns = (uint64_t)((double)compress_ticks * 1e9 / (double)counter_frequency);
+            yep_report_add(report, itr->name, uncompressed_size, data_size, compression_type, data_type, compress_ns);
+        }
+
         // shift the end pointer of the data pack file
         data_end += data_size;
 
         // incr
-        itr = itr->next;
         current_entry++;
 
-        displayProgressBar(current_entry, yep_pack_list.entry_count);
+        // report progress, rate limited so tiny entries dont drown the caller
+        progress.entries_done = (uint32_t)current_entry;
+        progress.bytes_in += uncompressed_size;
+        progress.bytes_out += data_size;
+        if(yep_options.progress_callback != NULL){
+            Uint64 now = SDL_GetTicks();
+            if(current_entry == yep_pack_list.entry_count || now - last_progress_ticks >= yep_options.progress_interval_ms){
+                progress.current = itr->name;
+                yep_options.progress_callback(&progress, yep_options.progress_userdata);
+                last_progress_ticks = now;
+            }
+        }
+
+        itr = itr->next;
+    }
+    if(fclose(pack_file) != 0)
+        ok = false;
+
+    // the pack itself is complete either way, a missing report only fails the run
+    *report_ok = true;
+    if(report != NULL){
+        if(ok)
+            *report_ok = yep_report_write(report, yep_options.report_path, output_name);
+        yep_report_free(report);
     }
-    printf("\n\n"); // let next log start on new line
-    fclose(pack_file);
 
     // clean up global pack list and variables
     struct yep_header_node *itr2 = yep_pack_list.head;
     while(itr2 != NULL){
         struct yep_header_node *next = itr2->next;
-        free(itr2->fullpath);
-        free(itr2);
+        _yep_free_node(itr2);
         itr2 = next;
     }
     yep_pack_list.head = NULL;
     yep_pack_list.entry_count = 0;
+
+    return ok;
 }
 
-bool yep_item_exists(const char* file, const char* handle) {
-    // open the file
-	if(!_yep_open_file(file)){
-		yep_logf(yep_log_warning,"Error opening yep file %s\n", file);
-		return false;
-	}
+/*
+    ============================ ANIMATION GROUPING ==============================
+*/
+
+struct frame_candidate {
+    uint32_t node_index;        // position in the original pack list
+    size_t prefix_length;       // "dir/walk_" of "dir/walk_012.png"
+    const char *extension;
+    uint32_t number;
+};
+
+static struct yep_header_node **frame_candidate_nodes;
+
+static int compare_frame_candidates(const void *a, const void *b){
+    const struct frame_candidate *x = a;
+    const struct frame_candidate *y = b;
+    const char *x_name = frame_candidate_nodes[x->node_index]->name;
+    const char *y_name = frame_candidate_nodes[y->node_index]->name;
+
+    // group by prefix and extension, then order frames by number
+    size_t shorter = x->prefix_length < y->prefix_length ? x->prefix_length : y->prefix_length;
+    int order = memcmp(x_name, y_name, shorter);
+    if(order == 0 && x->prefix_length != y->prefix_length)
+        order = x->prefix_length < y->prefix_length ? -1 : 1;
+    if(order == 0)
+        order = strcmp(x->extension, y->extension);
+    if(order == 0 && x->number != y->number)
+        order = x->number < y->number ? -1 : 1;
+    if(order == 0)
+        order = strcmp(x_name, y_name);
+    return order;
+}
+
+static bool same_sequence(const struct frame_candidate *x, const struct frame_candidate *y){
+    return x->prefix_length == y->prefix_length &&
+           memcmp(frame_candidate_nodes[x->node_index]->name, frame_candidate_nodes[y->node_index]->name, x->prefix_length) == 0 &&
+           strcmp(x->extension, y->extension) == 0;
+}
+
+// "sprites/walk_" -> "sprites/walk.anim", "sprites/run/" -> "sprites/run.anim"
+static bool animation_name(const char *frame_name, size_t prefix_length, char name[64]){
+    char prefix[64];
+    memcpy(prefix, frame_name, prefix_length);
+    prefix[prefix_length] = '\0';
+
+    while(prefix_length > 0 && strchr("_-. /", prefix[prefix_length - 1]) != NULL)
+        prefix[--prefix_length] = '\0';
+
+    int written = snprintf(name, 64, "%s.anim", prefix_length > 0 ? prefix : "animation");
+    return written > 0 && written < 64;
+}
+
+/*
+    Folds numbered frame sequences into a single animation node each, the frames
+    move to that node's frame list in order
+*/
+static void _yep_group_animations(void){
+    uint32_t count = (uint32_t)yep_pack_list.entry_count;
+    if(count < 2)
+        return;
+
+    struct yep_header_node **nodes = malloc(count * sizeof(struct yep_header_node *));
+    uint32_t *owners = calloc(count, sizeof(uint32_t));     // animation index + 1, 0 if not a frame
+    struct frame_candidate *candidates = malloc(count * sizeof(struct frame_candidate));
+    struct yep_header_node **animations = malloc(count * sizeof(struct yep_header_node *));
+    uint32_t candidate_count = 0;
+    uint32_t animation_count = 0;
+
+    uint32_t index = 0;
+    for(struct yep_header_node *itr = yep_pack_list.head; itr != NULL; itr = itr->next, index++){
+        nodes[index] = itr;
+
+        struct frame_candidate *candidate = &candidates[candidate_count];
+        if(yep_animation_frame_name(itr->name, &candidate->prefix_length, &candidate->number)){
+            candidate->node_index = index;
+            candidate->extension = strrchr(itr->name, '.');
+            candidate_count++;
+        }
+    }
+
+    frame_candidate_nodes = nodes;
+    qsort(candidates, candidate_count, sizeof(struct frame_candidate), compare_frame_candidates);
+
+    for(uint32_t start = 0, end; start < candidate_count; start = end){
+        end = start + 1;
+        while(end < candidate_count && same_sequence(&candidates[start], &candidates[end]))
+            end++;
+
+        if(end - start < 2)
+            continue;
+
+        const char *first = nodes[candidates[start].node_index]->name;
+        char name[64] = {0};
+        bool name_free = animation_name(first, candidates[start].prefix_length, name);
+        for(uint32_t i = 0; name_free && i < count; i++)
+            name_free = strcmp(nodes[i]->name, name) != 0;
+        for(uint32_t i = 0; name_free && i < animation_count; i++)
+            name_free = strcmp(animations[i]->name, name) != 0;
+
+        if(!name_free){
+            yep_logf(yep_log_debug,"Not bundling frames of %s, no free entry name\n", first);
+            continue;
+        }
+
+        struct yep_header_node *animation = calloc(1, sizeof(struct yep_header_node));
+        memcpy(animation->name, name, sizeof(name));
+        animations[animation_count++] = animation;
+
+        for(uint32_t i = start; i < end; i++)
+            owners[candidates[i].node_index] = animation_count;
+
+        // chain the frames in order (nodes[] still holds the old list order)
+        for(uint32_t i = start; i < end; i++)
+            nodes[candidates[i].node_index]->next = i + 1 < end ? nodes[candidates[i + 1].node_index] : NULL;
+        animation->frames = nodes[candidates[start].node_index];
+
+        yep_logf(yep_log_debug,"Bundling %u frames into %s\n", end - start, name);
+    }
+
+    // rebuild the pack list, each animation takes the place of its first frame
+    if(animation_count > 0){
+        bool *placed = calloc(animation_count, sizeof(bool));
+        struct yep_header_node *head = NULL;
+        struct yep_header_node **tail = &head;
+        int entry_count = 0;
+
+        for(uint32_t i = 0; i < count; i++){
+            struct yep_header_node *node = nodes[i];
+            if(owners[i] != 0){
+                if(placed[owners[i] - 1])
+                    continue;
+                placed[owners[i] - 1] = true;
+                node = animations[owners[i] - 1];
+            }
+
+            *tail = node;
+            tail = &node->next;
+            entry_count++;
+        }
+        *tail = NULL;
+
+        yep_pack_list.head = head;
+        yep_pack_list.entry_count = entry_count;
+        free(placed);
+    }
+
+    free(animations);
+    free(candidates);
+    free(owners);
+    free(nodes);
+}
+
+/*
+    =============================== ATLAS BUILDING ===============================
+*/
+
+#ifdef YEP_HAVE_SDL_IMAGE
+
+static size_t directory_length(const char *name){
+    const char *slash = strrchr(name, '/');
+    return slash ? (size_t)(slash - name) + 1 : 0;
+}
+
+// groups images by their directory, then orders them by name
+static int compare_atlas_images(const void *a, const void *b){
+    const struct yep_atlas_image *x = a;
+    const struct yep_atlas_image *y = b;
+
+    size_t x_dir = directory_length(x->name);
+    size_t y_dir = directory_length(y->name);
+    size_t shorter = x_dir < y_dir ? x_dir : y_dir;
+
+    int order = memcmp(x->name, y->name, shorter);
+    if(order == 0 && x_dir != y_dir)
+        order = x_dir < y_dir ? -1 : 1;
+    if(order == 0)
+        order = strcmp(x->name, y->name);
+    return order;
+}
+
+static bool name_in_nodes(struct yep_header_node **nodes, uint32_t count, const char *name){
+    for(uint32_t i = 0; i < count; i++){
+        if(strcmp(nodes[i]->name, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static struct yep_header_node *generated_node(const char *name, char *payload, size_t size, uint8_t data_type){
+    struct yep_header_node *node = calloc(1, sizeof(struct yep_header_node));
+    snprintf(node->name, sizeof(node->name), "%s", name);
+    node->payload = payload;
+    node->payload_size = (uint32_t)size;
+    node->data_type = data_type;
+    return node;
+}
+
+#endif
+
+/*
+    Replaces the small images of each directory with atlas pages and a region table
+*/
+static void _yep_build_atlases(void){
+#ifndef YEP_HAVE_SDL_IMAGE
+    yep_logf(yep_log_warning,"libyep was built without YEP_IMAGE_SUPPORT, skipping atlas packing\n");
+#else
+    uint32_t count = (uint32_t)yep_pack_list.entry_count;
+    uint32_t max_size = yep_options.atlas_max_size;
+    uint32_t page_size = yep_options.atlas_page_size;
+
+    // every image is padded by a pixel on each side
+    if(page_size < 3){
+        yep_logf(yep_log_warning,"Atlas page size %u is too small, skipping atlas packing\n", page_size);
+        return;
+    }
+    if(max_size + 2 > page_size)
+        max_size = page_size - 2;
+
+    struct yep_header_node **nodes = malloc((count ? count : 1) * sizeof(struct yep_header_node *));
+    struct yep_atlas_image *images = malloc((count ? count : 1) * sizeof(struct yep_atlas_image));
+    bool *removed = calloc(count ? count : 1, sizeof(bool));
+    uint32_t image_count = 0;
+
+    uint32_t index = 0;
+    for(struct yep_header_node *itr = yep_pack_list.head; itr != NULL; itr = itr->next, index++){
+        nodes[index] = itr;
+        if(itr->frames != NULL || itr->payload != NULL || !yep_is_image_path(itr->name))
+            continue;
+
+        FILE *file = fopen(itr->fullpath, "rb");
+        if(file == NULL)
+            continue;
+        uint32_t size = get_file_size(file);
+        char *data = read_file_data(file, size);
+        fclose(file);
+
+        struct yep_atlas_image *image = &images[image_count];
+        bool decoded = yep_image_decode_rgba(data, size, &image->pixels, &image->width, &image->height);
+        free(data);
+        if(!decoded)
+            continue;
+
+        if(image->width == 0 || image->height == 0 || image->width > max_size || image->height > max_size){
+            free(image->pixels);
+            continue;
+        }
+
+        image->name = itr->name;
+        image->source = index;
+        image_count++;
+    }
+
+    qsort(images, image_count, sizeof(struct yep_atlas_image), compare_atlas_images);
+
+    struct yep_header_node *added = NULL;
+    int added_count = 0;
+
+    for(uint32_t start = 0, end; start < image_count; start = end){
+        size_t dir = directory_length(images[start].name);
+        end = start + 1;
+        while(end < image_count && directory_length(images[end].name) == dir && memcmp(images[end].name, images[start].name, dir) == 0)
+            end++;
+
+        // a single image gains nothing from an atlas
+        if(end - start < 2)
+            continue;
+
+        char prefix[64];
+        memcpy(prefix, images[start].name, dir);
+        prefix[dir] = '\0';
+
+        struct yep_atlas_output atlas;
+        if(!yep_atlas_build(prefix, &images[start], end - start, page_size, yep_options.image_mips, &atlas)){
+            yep_logf(yep_log_debug,"Not building an atlas for \"%s\", the page names do not fit\n", prefix);
+            continue;
+        }
+
+        bool names_free = !name_in_nodes(nodes, count, atlas.table_name);
+        for(uint32_t page = 0; page < atlas.page_count && names_free; page++)
+            names_free = !name_in_nodes(nodes, count, atlas.page_names[page]);
+        if(!names_free){
+            yep_logf(yep_log_warning,"Not building an atlas for \"%s\", an entry already uses its name\n", prefix);
+            yep_atlas_output_free(&atlas);
+            continue;
+        }
+
+        for(uint32_t page = 0; page < atlas.page_count; page++){
+            struct yep_header_node *node = generated_node(atlas.page_names[page], atlas.pages[page], atlas.page_sizes[page], YEP_DATATYPE_IMAGE);
+            atlas.pages[page] = NULL;
+            node->next = added;
+            added = node;
+            added_count++;
+        }
+
+        struct yep_header_node *table = generated_node(atlas.table_name, atlas.table, atlas.table_size, YEP_DATATYPE_ATLAS);
+        atlas.table = NULL;
+        table->next = added;
+        added = table;
+        added_count++;
+
+        // the handles stop resolving as entries, callers that load them by name have to notice
+        for(uint32_t i = start; i < end; i++){
+            removed[images[i].source] = true;
+            yep_logf(yep_log_info,"Folded %s into atlas \"%s\", find it with yep_pack_find_region()\n", images[i].name, atlas.table_name);
+        }
+
+        yep_logf(yep_log_debug,"Packed %u images of \"%s\" into %u atlas pages\n", end - start, prefix, atlas.page_count);
+        yep_atlas_output_free(&atlas);
+    }
+
+    for(uint32_t i = 0; i < image_count; i++)
+        free(images[i].pixels);
+
+    // rebuild the list without the packed images, then add the pages and tables
+    struct yep_header_node *head = NULL;
+    struct yep_header_node **tail = &head;
+    int entry_count = 0;
+    for(uint32_t i = 0; i < count; i++){
+        if(removed[i]){
+            _yep_free_node(nodes[i]);
+            continue;
+        }
+        *tail = nodes[i];
+        tail = &nodes[i]->next;
+        entry_count++;
+    }
+    *tail = added;
+
+    yep_pack_list.head = head;
+    yep_pack_list.entry_count = entry_count + added_count;
 
-	// setup the data we will seek out of the yep file
-	char name[64];
-	uint32_t offset;
-	uint32_t size;
-	uint8_t compression_type;
-	uint32_t uncompressed_size;
-	uint8_t data_type;
+    free(removed);
+    free(images);
+    free(nodes);
+#endif
+}
+
+/*
+    ================================ ENTRY ORDER =================================
+*/
+
+static int _yep_compare_node_names(const void *a, const void *b){
+    const struct yep_header_node *x = *(struct yep_header_node *const *)a;
+    const struct yep_header_node *y = *(struct yep_header_node *const *)b;
+    return strcmp(x->name, y->name);
+}
+
+// directory enumeration order depends on the filesystem, sorting makes entry ids reproducible
+static void _yep_sort_pack_list(void){
+    uint32_t count = 0;
+    for(struct yep_header_node *itr = yep_pack_list.head; itr != NULL; itr = itr->next)
+        count++;
+    if(count < 2)
+        return;
 
-	// try to get our header
-	if(!_yep_seek_header(handle, name, &offset, &size, &compression_type, &uncompressed_size, &data_type)){
-		return false;
-	}
+    struct yep_header_node **nodes = malloc(count * sizeof(struct yep_header_node *));
+    uint32_t i = 0;
+    for(struct yep_header_node *itr = yep_pack_list.head; itr != NULL; itr = itr->next)
+        nodes[i++] = itr;
 
-	return true;
+    qsort(nodes, count, sizeof(struct yep_header_node *), _yep_compare_node_names);
+
+    for(i = 0; i + 1 < count; i++)
+        nodes[i]->next = nodes[i + 1];
+    nodes[count - 1]->next = NULL;
+    yep_pack_list.head = nodes[0];
+
+    free(nodes);
 }
 
 bool _yep_pack_directory(char *directory_path, char *output_name){
@@ -689,6 +2146,9 @@ bool _yep_pack_directory(char *directory_path, char *output_name){
     yep_pack_root_path = strdup(directory_path);
     normalize_path_separators(yep_pack_root_path);
 
+    if(yep_options.depfile_path != NULL)
+        yep_pack_deps = yep_depfile_create();
+
     // call walk directory (first arg is root, second is current - this is for recursive relative path knowledge)
     _yep_walk_directory_v2(directory_path);
 
@@ -698,6 +2158,15 @@ bool _yep_pack_directory(char *directory_path, char *output_name){
 
     yep_logf(yep_log_debug,"Built pack list...\n");
 
+    if(yep_options.bundle_animations)
+        _yep_group_animations();
+
+    // after animations, so frames stay in their sequence
+    if(yep_options.atlas_max_size > 0)
+        _yep_build_atlases();
+
+    _yep_sort_pack_list();
+
     // print out all the LL nodes
     // struct yep_header_node *itr = yep_pack_list.head;
     // while(itr != NULL){
@@ -713,10 +2182,23 @@ bool _yep_pack_directory(char *directory_path, char *output_name){
         with zerod data for the rest of the fields other than its name
     */
 
+    // the previous pack has to be read before opening the output truncates it
+    struct yep_cache *cache = NULL;
+    if(yep_options.cache_path != NULL)
+        cache = yep_cache_open(yep_options.cache_path, output_name, yep_cache_options_key(&yep_options), yep_pack_stats);
+
+    // written next to the output and renamed over it once complete, so a running engine
+    // that has the previous pack mapped never sees it truncated or half written
+    char temp_name[4096];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", output_name);
+
     // open the output file
-    FILE *file = fopen(output_name, "wb");
+    FILE *file = fopen(temp_name, "wb");
     if (file == NULL) {
-        yep_logf(yep_log_error,"Error opening yep file %s\n", output_name);
+        yep_logf(yep_log_error,"Error opening yep file %s\n", temp_name);
+        yep_cache_close(cache);
+        yep_depfile_free(yep_pack_deps);
+        yep_pack_deps = NULL;
         return false;
     }
 
@@ -763,34 +2245,83 @@ bool _yep_pack_directory(char *directory_path, char *output_name){
 
     yep_logf(yep_log_debug,"Writing data...\n");
 
-    // write the data
-    write_pack_file(file);
+    // write the data, a half written pack is thrown away so the previous one stays in place
+    bool ok;
+    if(!write_pack_file(file, output_name, cache, &ok)){
+        yep_logf(yep_log_error,"Error writing %s, keeping the previous pack\n", output_name);
+        remove(temp_name);
+        yep_cache_close(cache);
+        yep_depfile_free(yep_pack_deps);
+        yep_pack_deps = NULL;
+        return false;
+    }
+
+    if(!SDL_RenamePath(temp_name, output_name)){
+        yep_logf(yep_log_error,"Error replacing %s: %s\n", output_name, SDL_GetError());
+        SDL_RemovePath(temp_name);
+        yep_cache_close(cache);
+        yep_depfile_free(yep_pack_deps);
+        yep_pack_deps = NULL;
+        return false;
+    }
+
+    if(cache != NULL){
+        yep_logf(yep_log_info,"Reused %u unchanged entries from the previous pack\n", yep_cache_hits(cache));
+        yep_cache_save(cache, yep_options.cache_path, output_name);
+        yep_cache_close(cache);
+    }
+
+    // written last, so a failed pack is rerun by the build system
+    if(yep_pack_deps != NULL){
+        if(ok)
+            ok = yep_depfile_write(yep_pack_deps, yep_options.depfile_path, output_name);
+        yep_depfile_free(yep_pack_deps);
+        yep_pack_deps = NULL;
+    }
 
     yep_logf(yep_log_debug,"Done!\n");
 
-    return true;
+    // the header is generated from the finished pack, so it always matches what readers see
+    if(ok && yep_options.header_path != NULL)
+        ok = yep_write_id_header(output_name, yep_options.header_path);
+
+    return ok;
 }
 
 bool yep_force_pack_directory(char *directory_path, char *output_name){
     yep_logf(yep_log_debug,"Forcing pack of directory \"%s\"...\n", directory_path);
-    return _yep_pack_directory(directory_path, output_name);
+
+    yep_pack_stats = yep_stat_cache_create();
+    bool ok = _yep_pack_directory(directory_path, output_name);
+    yep_stat_cache_free(yep_pack_stats);
+    yep_pack_stats = NULL;
+    return ok;
 }
 
 bool yep_pack_directory(char *directory_path, char *output_name){
+    // lives for the whole run, so every file is statted at most once
+    yep_pack_stats = yep_stat_cache_create();
+
+    bool ok = true;
     if(is_dir_outofdate(directory_path, output_name)){
         yep_logf(yep_log_debug,"Target directory \"%s\" is out of date, packing...\n", directory_path);
-        return _yep_pack_directory(directory_path, output_name);
+        ok = _yep_pack_directory(directory_path, output_name);
     } else {
         yep_logf(yep_log_debug,"Target directory \"%s\" is up to date, skipping...\n", directory_path);
-        return true;
+
+        // cheap to redo, and covers a header that was deleted while the pack was not
+        if(yep_options.header_path != NULL)
+            ok = yep_write_id_header(output_name, yep_options.header_path);
     }
+
+    yep_stat_cache_free(yep_pack_stats);
+    yep_pack_stats = NULL;
+    return ok;
 }
 
 /*
     YEP TODO:
-    - native animation functionality (this will cutout a lot of headers)
     - actually hook an API so engine can get certain types
-    - encode the RGBA and PCM data rather than the file binary
 */
 
 /*
@@ -7,28 +7,163 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "libyep.h"
+#include "yep_cmd.h"
 
 void print_usage(void) {
-    printf("Usage: yep <input_directory> <output_file.yep>\n");
+    printf("Usage: yep [options] [pack options] <input_directory> <output_file.yep>\n");
+    printf("       yep [options] <command> [args]\n");
     printf("Pack a directory into a .yep pack file\n\n");
     printf("Arguments:\n");
     printf("  input_directory   Directory to pack\n");
-    printf("  output_file.yep   Output pack file path\n");
+    printf("  output_file.yep   Output pack file path\n\n");
+    printf("Commands:\n");
+    printf("  pack              Pack a directory (same as the default form)\n");
+    printf("  watch             Pack a directory, then repack it whenever a file changes\n");
+    printf("  list              List the entries of a pack\n");
+    printf("  info              Print statistics about a pack\n");
+    printf("  extract           Extract entries of a pack to disk\n");
+    printf("  bench             Measure lookup and extraction performance of a pack\n");
+    printf("  serve             Keep packs open and serve their entries to other processes over a socket\n");
+    printf("  mount             Mount a pack as a read-only filesystem (FUSE)\n\n");
+    printf("Pack options:\n");
+    printf("  --report <file>   Write a JSON report of per entry sizes and compression times\n");
+    printf("  --header <file>   Write a C header of entry ids and hashes for yep_extract_by_id\n");
+    printf("  --cache <file>    Only repack files that changed since the cache was written\n");
+    printf("  --depfile <file>  Write a Make/Ninja depfile of every input file and directory\n");
+    printf("  --images          Store images as decoded RGBA pixels\n");
+    printf("  --mips            Like --images, and also store a mip chain\n");
+    printf("  --audio           Store wav files as raw PCM with a lossless PCM codec\n");
+    printf("  --lua             Store lua scripts as precompiled bytecode\n");
+    printf("  --lua-debug       Like --lua, and keep debug info so stack traces name the script and line\n");
+    printf("  --animations      Bundle numbered frames (walk_000.png, ...) into one .anim entry\n");
+    printf("  --delta-frames    Like --animations, decoded image frames store only the change to the previous one\n");
+    printf("  --atlas <px>      Pack images no larger than <px> into per directory atlas pages\n");
+    printf("                    (they are then only found as atlas regions, not as entries)\n");
+    printf("  --atlas-page <px> Maximum atlas page size (default: 1024)\n\n");
+    printf("Options:\n");
+    printf("  -v, --verbose     Print debug output\n");
+    printf("  -q, --quiet       Only print errors\n");
 }
 
-int main(int argc, char **argv) {
-    if (argc != 3) {
+/*
+    Renders the packer progress as a single line bar, built in one buffer so each
+    update is a single write
+*/
+static void render_progress(const struct yep_pack_progress *progress, void *userdata) {
+    (void)userdata; // unused
+
+    const int bar_length = 50;
+    float fraction = progress->entries_total ? (float)progress->entries_done / progress->entries_total : 1.0f;
+    int filled = (int)(fraction * bar_length);
+
+    char line[160];
+    int len = 0;
+    line[len++] = '\r';
+    line[len++] = '[';
+    for (int i = 0; i < bar_length; i++)
+        line[len++] = i < filled ? '=' : ' ';
+    len += snprintf(line + len, sizeof(line) - len, "] %.2f%% (%u/%u) %.1f MiB -> %.1f MiB",
+        fraction * 100.0f, progress->entries_done, progress->entries_total,
+        progress->bytes_in / (1024.0 * 1024.0), progress->bytes_out / (1024.0 * 1024.0));
+
+    fputs(line, stdout);
+    if (progress->entries_done == progress->entries_total)
+        fputs("\n", stdout);
+    fflush(stdout);
+}
+
+/*
+    Parses [pack options] <input_directory> <output_file.yep>, shared by pack and watch
+*/
+static bool parse_pack_args(int argc, char **argv, struct yep_pack_options *options,
+                            const char **input_dir, const char **output_file) {
+    const char *positional[2] = {NULL, NULL};
+    int positional_count = 0;
+
+    yep_pack_options_init(options);
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            options->report_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--header") == 0 && i + 1 < argc) {
+            options->header_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            options->cache_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--depfile") == 0 && i + 1 < argc) {
+            options->depfile_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--images") == 0) {
+            options->decode_images = true;
+        }
+        else if (strcmp(argv[i], "--mips") == 0) {
+            options->decode_images = true;
+            options->image_mips = true;
+        }
+        else if (strcmp(argv[i], "--audio") == 0) {
+            options->decode_audio = true;
+        }
+        else if (strcmp(argv[i], "--lua") == 0) {
+            options->compile_lua = true;
+        }
+        else if (strcmp(argv[i], "--lua-debug") == 0) {
+            options->compile_lua = true;
+            options->lua_debug_info = true;
+        }
+        else if (strcmp(argv[i], "--animations") == 0) {
+            options->bundle_animations = true;
+        }
+        else if (strcmp(argv[i], "--delta-frames") == 0) {
+            options->bundle_animations = true;
+            options->animation_delta = true;
+        }
+        else if (strcmp(argv[i], "--atlas") == 0 && i + 1 < argc) {
+            options->atlas_max_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--atlas-page") == 0 && i + 1 < argc) {
+            // a page has to fit at least one padded pixel
+            options->atlas_page_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (options->atlas_page_size < 3)
+                return false;
+        }
+        else if (argv[i][0] == '-' || positional_count == 2) {
+            return false;
+        }
+        else {
+            positional[positional_count++] = argv[i];
+        }
+    }
+
+    if (positional_count != 2)
+        return false;
+
+    *input_dir = positional[0];
+    *output_file = positional[1];
+    return true;
+}
+
+static int cmd_pack(int argc, char **argv) {
+    struct yep_pack_options options;
+    const char *input_dir;
+    const char *output_file;
+    if (!parse_pack_args(argc, argv, &options, &input_dir, &output_file)) {
         print_usage();
         return 1;
     }
 
-    const char *input_dir = argv[1];
-    const char *output_file = argv[2];
-
     yep_initialize();
-    
+
+    // the library never prints progress itself, we render it here
+    if (yep_log_threshold <= yep_log_info)
+        options.progress_callback = render_progress;
+
+    yep_set_pack_options(&options);
+
     yep_logf(yep_log_info, "Packing directory: %s into %s\n", input_dir, output_file);
 
     if (!yep_force_pack_directory((char *)input_dir, (char *)output_file)) {
@@ -40,3 +175,68 @@ int main(int argc, char **argv) {
     yep_shutdown();
     return 0;
 }
+
+static int cmd_watch(int argc, char **argv) {
+    struct yep_pack_options options;
+    const char *input_dir;
+    const char *output_file;
+    if (!parse_pack_args(argc, argv, &options, &input_dir, &output_file)) {
+        print_usage();
+        return 1;
+    }
+
+    // rebuilds only make sense if unchanged entries are reused
+    char cache_path[4096];
+    if (options.cache_path == NULL) {
+        snprintf(cache_path, sizeof(cache_path), "%s.cache", output_file);
+        options.cache_path = cache_path;
+    }
+
+    yep_initialize();
+    yep_set_pack_options(&options);
+
+    int result = yep_watch(input_dir, output_file);
+
+    yep_shutdown();
+    return result;
+}
+
+static const struct {
+    const char *name;
+    int (*run)(int argc, char **argv);
+} commands[] = {
+    { "pack",    cmd_pack },
+    { "watch",   cmd_watch },
+    { "list",    yep_cmd_list },
+    { "info",    yep_cmd_info },
+    { "extract", yep_cmd_extract },
+    { "bench",   yep_cmd_bench },
+    { "serve",   yep_cmd_serve },
+    { "mount",   yep_cmd_mount },
+};
+
+int main(int argc, char **argv) {
+    // global flags come before the command
+    int first = 1;
+    for (; first < argc; first++) {
+        if (strcmp(argv[first], "-v") == 0 || strcmp(argv[first], "--verbose") == 0)
+            yep_set_log_level(yep_log_debug);
+        else if (strcmp(argv[first], "-q") == 0 || strcmp(argv[first], "--quiet") == 0)
+            yep_set_log_level(yep_log_error);
+        else
+            break;
+    }
+
+    if (first >= argc) {
+        print_usage();
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strcmp(argv[first], commands[i].name) == 0)
+            return commands[i].run(argc - first - 1, argv + first + 1);
+    }
+
+    // no command, the original <input_directory> <output_file.yep> form
+    return cmd_pack(argc - first, argv + first);
+}
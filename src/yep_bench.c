@@ -0,0 +1,514 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    yep_bench: generates reproducible synthetic corpora, packs them and measures
+    pack throughput, open latency, lookup latency and extraction throughput.
+
+    Results are written as a single JSON document (stdout or --out), a short human
+    readable summary goes to stderr. The same --seed always produces the same corpus.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <SDL3/SDL.h>
+
+#include "yepfs.h"
+#include "libyep.h"
+
+#define YEP_BENCH_SCHEMA_VERSION 1
+
+/*
+    ================================ DETERMINISTIC RNG ================================
+*/
+
+static uint64_t bench_rng_state;
+
+static uint64_t bench_rand(void) {
+    // splitmix64
+    uint64_t z = (bench_rng_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t bench_rand_range(uint32_t min, uint32_t max) {
+    return min + (uint32_t)(bench_rand() % (uint64_t)(max - min + 1));
+}
+
+/*
+    ==================================== TIMING =====================================
+*/
+
+static uint64_t bench_now_ns(void) {
+    static uint64_t frequency = 0;
+    if(frequency == 0)
+        frequency = SDL_GetPerformanceFrequency();
+
+    uint64_t counter = SDL_GetPerformanceCounter();
+    return (uint64_t)((double)counter * 1e9 / (double)frequency);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// sorts samples in place
+static uint64_t percentile(uint64_t *samples, size_t count, double p) {
+    if(count == 0)
+        return 0;
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return samples[index];
+}
+
+/*
+    ================================ CORPUS GENERATION ================================
+*/
+
+static const char *bench_words[] = {
+    "entity", "transform", "sprite", "render", "layer", "camera", "audio", "script",
+    "physics", "collider", "button", "scene", "prefab", "texture", "volume", "position",
+    "rotation", "scale", "true", "false", "null", "width", "height", "color",
+};
+
+struct bench_corpus {
+    const char *name;
+    char dir[512];
+    char pack[512];
+
+    // relative handles of every generated file
+    char **handles;
+    size_t count;
+    size_t capacity;
+
+    uint64_t raw_bytes;
+};
+
+static void corpus_add(struct bench_corpus *corpus, const char *handle, size_t size) {
+    if(corpus->count == corpus->capacity) {
+        corpus->capacity = corpus->capacity ? corpus->capacity * 2 : 256;
+        corpus->handles = realloc(corpus->handles, corpus->capacity * sizeof(char *));
+    }
+    corpus->handles[corpus->count++] = strdup(handle);
+    corpus->raw_bytes += size;
+}
+
+static void corpus_free(struct bench_corpus *corpus) {
+    for(size_t i = 0; i < corpus->count; i++)
+        free(corpus->handles[i]);
+    free(corpus->handles);
+    memset(corpus, 0, sizeof(*corpus));
+}
+
+static void fill_text(char *buffer, size_t size) {
+    size_t written = 0;
+    size_t word_count = sizeof(bench_words) / sizeof(bench_words[0]);
+    while(written < size) {
+        const char *word = bench_words[bench_rand() % word_count];
+        char sep = (bench_rand() % 8 == 0) ? '\n' : ' ';
+        while(*word && written < size)
+            buffer[written++] = *word++;
+        if(written < size)
+            buffer[written++] = sep;
+    }
+}
+
+static void fill_random(char *buffer, size_t size) {
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8) {
+        uint64_t value = bench_rand();
+        memcpy(buffer + i, &value, 8);
+    }
+    for(; i < size; i++)
+        buffer[i] = (char)bench_rand();
+}
+
+// mixes random runs with repeated runs, compressibility controlled by repeat_percent
+static void fill_mixed(char *buffer, size_t size, uint32_t repeat_percent) {
+    size_t written = 0;
+    while(written < size) {
+        size_t run = bench_rand_range(64, 4096);
+        if(run > size - written)
+            run = size - written;
+
+        if(written >= 256 && bench_rand_range(0, 99) < repeat_percent) {
+            size_t back = bench_rand_range(1, (uint32_t)(written < 4096 ? written : 4096));
+            for(size_t i = 0; i < run; i++)
+                buffer[written + i] = buffer[written - back + i];
+        } else {
+            fill_random(buffer + written, run);
+        }
+        written += run;
+    }
+}
+
+enum bench_fill { BENCH_FILL_TEXT, BENCH_FILL_RANDOM, BENCH_FILL_MIXED };
+
+static bool write_corpus_file(struct bench_corpus *corpus, const char *handle, size_t size, enum bench_fill fill) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", corpus->dir, handle);
+
+    // make sure the parent exists
+    char *slash = strrchr(path, '/');
+    *slash = '\0';
+    SDL_CreateDirectory(path);
+    *slash = '/';
+
+    char *buffer = malloc(size ? size : 1);
+    switch(fill) {
+        case BENCH_FILL_TEXT:   fill_text(buffer, size); break;
+        case BENCH_FILL_RANDOM: fill_random(buffer, size); break;
+        case BENCH_FILL_MIXED:  fill_mixed(buffer, size, bench_rand_range(0, 100)); break;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if(file == NULL) {
+        fprintf(stderr, "yep_bench: failed to write %s\n", path);
+        free(buffer);
+        return false;
+    }
+    fwrite(buffer, 1, size, file);
+    fclose(file);
+    free(buffer);
+
+    corpus_add(corpus, handle, size);
+    return true;
+}
+
+static bool generate_tiny_text(struct bench_corpus *corpus, size_t count) {
+    char handle[64];
+    for(size_t i = 0; i < count; i++) {
+        snprintf(handle, sizeof(handle), "t%02zu/f%06zu.txt", i / 1000, i);
+        if(!write_corpus_file(corpus, handle, bench_rand_range(32, 2048), BENCH_FILL_TEXT))
+            return false;
+    }
+    return true;
+}
+
+static bool generate_large_binary(struct bench_corpus *corpus, size_t count, size_t size) {
+    char handle[64];
+    for(size_t i = 0; i < count; i++) {
+        snprintf(handle, sizeof(handle), "bin/large%02zu.bin", i);
+        if(!write_corpus_file(corpus, handle, size, BENCH_FILL_RANDOM))
+            return false;
+    }
+    return true;
+}
+
+static bool generate_mixed(struct bench_corpus *corpus, size_t count) {
+    char handle[64];
+    for(size_t i = 0; i < count; i++) {
+        snprintf(handle, sizeof(handle), "mix/m%05zu.dat", i);
+        if(!write_corpus_file(corpus, handle, bench_rand_range(1024, 1024 * 1024), BENCH_FILL_MIXED))
+            return false;
+    }
+    return true;
+}
+
+static bool generate_deep_tree(struct bench_corpus *corpus, size_t depth, size_t files_per_level) {
+    char handle[64];
+    char prefix[64] = "";
+    for(size_t level = 0; level < depth; level++) {
+        size_t len = strlen(prefix);
+        snprintf(prefix + len, sizeof(prefix) - len, "d%zx/", level);
+        for(size_t i = 0; i < files_per_level; i++) {
+            snprintf(handle, sizeof(handle), "%sf%zu.txt", prefix, i);
+            if(!write_corpus_file(corpus, handle, bench_rand_range(128, 8192), BENCH_FILL_TEXT))
+                return false;
+        }
+    }
+    return true;
+}
+
+// many tiny entries, used for lookup latency at a given entry count
+static bool generate_lookup(struct bench_corpus *corpus, size_t count) {
+    char handle[64];
+    for(size_t i = 0; i < count; i++) {
+        snprintf(handle, sizeof(handle), "l%03zu/e%06zu", i / 500, i);
+        if(!write_corpus_file(corpus, handle, bench_rand_range(16, 128), BENCH_FILL_TEXT))
+            return false;
+    }
+    return true;
+}
+
+/*
+    ==================================== RESULTS ====================================
+*/
+
+static FILE *bench_out;
+static bool bench_first_result = true;
+
+static void result_begin(const char *benchmark, const char *corpus) {
+    fprintf(bench_out, "%s\n    {\"benchmark\": \"%s\", \"corpus\": \"%s\"", bench_first_result ? "" : ",", benchmark, corpus);
+    bench_first_result = false;
+}
+
+static void result_u64(const char *key, uint64_t value) {
+    fprintf(bench_out, ", \"%s\": %" PRIu64, key, value);
+}
+
+static void result_f64(const char *key, double value) {
+    fprintf(bench_out, ", \"%s\": %.6f", key, value);
+}
+
+static void result_end(void) {
+    fprintf(bench_out, "}");
+}
+
+/*
+    =================================== BENCHMARKS ===================================
+*/
+
+static bool bench_pack(struct bench_corpus *corpus) {
+    uint64_t start = bench_now_ns();
+    bool ok = yep_force_pack_directory(corpus->dir, corpus->pack);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    if(!ok) {
+        fprintf(stderr, "yep_bench: failed to pack %s\n", corpus->dir);
+        return false;
+    }
+
+    SDL_PathInfo info;
+    uint64_t pack_bytes = SDL_GetPathInfo(corpus->pack, &info) ? info.size : 0;
+    double seconds = elapsed / 1e9;
+
+    result_begin("pack", corpus->name);
+    result_u64("entries", corpus->count);
+    result_u64("raw_bytes", corpus->raw_bytes);
+    result_u64("pack_bytes", pack_bytes);
+    result_f64("seconds", seconds);
+    result_f64("mib_per_s", corpus->raw_bytes / (1024.0 * 1024.0) / seconds);
+    result_f64("entries_per_s", corpus->count / seconds);
+    result_end();
+
+    fprintf(stderr, "  pack    %-14s %7zu entries  %8.1f MiB/s  %10.0f entries/s\n",
+        corpus->name, corpus->count, corpus->raw_bytes / (1024.0 * 1024.0) / seconds, corpus->count / seconds);
+    return true;
+}
+
+// open latency: map the pack, validate it and build its index
+static void bench_open(struct bench_corpus *corpus, size_t iterations) {
+    uint64_t *samples = malloc(iterations * sizeof(uint64_t));
+    for(size_t i = 0; i < iterations; i++) {
+        uint64_t start = bench_now_ns();
+        struct yep_pack *pack = yep_pack_open(corpus->pack);
+        samples[i] = bench_now_ns() - start;
+        yep_pack_close(pack);
+    }
+
+    result_begin("open", corpus->name);
+    result_u64("entries", corpus->count);
+    result_u64("iterations", iterations);
+    result_u64("p50_ns", percentile(samples, iterations, 0.50));
+    result_u64("p99_ns", percentile(samples, iterations, 0.99));
+    result_end();
+
+    fprintf(stderr, "  open    %-14s p50 %10" PRIu64 " ns  p99 %10" PRIu64 " ns\n",
+        corpus->name, percentile(samples, iterations, 0.50), percentile(samples, iterations, 0.99));
+
+    free(samples);
+}
+
+static void bench_lookup(struct bench_corpus *corpus, size_t iterations) {
+    uint64_t *hit = malloc(iterations * sizeof(uint64_t));
+    uint64_t *miss = malloc(iterations * sizeof(uint64_t));
+    char missing[64];
+
+    // warm the handle so we only measure lookups
+    yep_item_exists(corpus->pack, corpus->handles[0]);
+
+    for(size_t i = 0; i < iterations; i++) {
+        const char *handle = corpus->handles[bench_rand() % corpus->count];
+        uint64_t start = bench_now_ns();
+        if(!yep_item_exists(corpus->pack, handle))
+            fprintf(stderr, "yep_bench: lookup of %s unexpectedly missed\n", handle);
+        hit[i] = bench_now_ns() - start;
+
+        snprintf(missing, sizeof(missing), "missing/%016" PRIx64, bench_rand());
+        start = bench_now_ns();
+        yep_item_exists(corpus->pack, missing);
+        miss[i] = bench_now_ns() - start;
+    }
+
+    result_begin("lookup", corpus->name);
+    result_u64("entries", corpus->count);
+    result_u64("iterations", iterations);
+    result_u64("hit_p50_ns", percentile(hit, iterations, 0.50));
+    result_u64("hit_p99_ns", percentile(hit, iterations, 0.99));
+    result_u64("miss_p50_ns", percentile(miss, iterations, 0.50));
+    result_u64("miss_p99_ns", percentile(miss, iterations, 0.99));
+    result_end();
+
+    fprintf(stderr, "  lookup  %-14s hit p50 %10" PRIu64 " ns  miss p50 %10" PRIu64 " ns\n",
+        corpus->name, percentile(hit, iterations, 0.50), percentile(miss, iterations, 0.50));
+
+    free(hit);
+    free(miss);
+}
+
+// extraction throughput, bucketed by the codec each entry was stored with
+static void bench_extract(struct bench_corpus *corpus) {
+    struct yep_pack *pack = yep_pack_open(corpus->pack);
+    if(pack == NULL)
+        return;
+
+    #define BENCH_CODEC_SLOTS 256
+    uint64_t bytes[BENCH_CODEC_SLOTS] = {0};
+    uint64_t nanos[BENCH_CODEC_SLOTS] = {0};
+    uint64_t entries[BENCH_CODEC_SLOTS] = {0};
+
+    for(uint32_t i = 0; i < yep_pack_entry_count(pack); i++) {
+        uint8_t codec = yep_pack_entry(pack, i)->compression_type;
+
+        uint64_t start = bench_now_ns();
+        struct yep_data_info data = yep_pack_extract(pack, i);
+        uint64_t elapsed = bench_now_ns() - start;
+
+        bytes[codec] += data.size;
+        nanos[codec] += elapsed;
+        entries[codec]++;
+
+        free(data.data);
+    }
+
+    for(int codec = 0; codec < BENCH_CODEC_SLOTS; codec++) {
+        if(entries[codec] == 0)
+            continue;
+
+        double seconds = nanos[codec] / 1e9;
+        result_begin("extract", corpus->name);
+        fprintf(bench_out, ", \"codec\": \"%s\"", yep_compression_name((uint8_t)codec));
+        result_u64("entries", entries[codec]);
+        result_u64("bytes", bytes[codec]);
+        result_f64("seconds", seconds);
+        result_f64("gib_per_s", bytes[codec] / (1024.0 * 1024.0 * 1024.0) / seconds);
+        result_end();
+
+        fprintf(stderr, "  extract %-14s %-6s %8.3f GiB/s  (%" PRIu64 " entries)\n",
+            corpus->name, yep_compression_name((uint8_t)codec), bytes[codec] / (1024.0 * 1024.0 * 1024.0) / seconds, entries[codec]);
+    }
+
+    yep_pack_close(pack);
+}
+
+/*
+    ====================================== MAIN ======================================
+*/
+
+static void print_usage(void) {
+    printf("Usage: yep_bench [options]\n");
+    printf("Generate synthetic corpora and benchmark packing and reading\n\n");
+    printf("Options:\n");
+    printf("  --out <file>      Write JSON results to a file instead of stdout\n");
+    printf("  --dir <path>      Working directory for corpora (default: yep_bench_work)\n");
+    printf("  --seed <n>        Corpus seed (default: 1)\n");
+    printf("  --quick           Smaller corpora and fewer samples\n");
+    printf("  --keep            Keep the generated corpora and packs\n");
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    const char *work_dir = "yep_bench_work";
+    uint64_t seed = 1;
+    bool quick = false;
+    bool keep = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else if(strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+            work_dir = argv[++i];
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if(strcmp(argv[i], "--quick") == 0)
+            quick = true;
+        else if(strcmp(argv[i], "--keep") == 0)
+            keep = true;
+        else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    bench_out = stdout;
+    if(out_path != NULL) {
+        bench_out = fopen(out_path, "w");
+        if(bench_out == NULL) {
+            fprintf(stderr, "yep_bench: could not open %s\n", out_path);
+            return 1;
+        }
+    }
+
+    yep_set_log_level(yep_log_warning);
+    yep_initialize();
+
+    if(SDL_GetPathInfo(work_dir, NULL))
+        yep_recurse_delete_dir(work_dir);
+    SDL_CreateDirectory(work_dir);
+
+    fprintf(bench_out, "{\n  \"schema\": %d,\n  \"format_version\": %d,\n  \"seed\": %" PRIu64 ",\n  \"quick\": %s,\n  \"results\": [",
+        YEP_BENCH_SCHEMA_VERSION, YEP_CURRENT_FORMAT_VERSION, seed, quick ? "true" : "false");
+
+    struct bench_corpus corpora[7];
+    memset(corpora, 0, sizeof(corpora));
+    const char *names[7] = { "tiny_text", "large_binary", "mixed", "deep_tree", "lookup_1k", "lookup_10k", "lookup_65k" };
+
+    int status = 0;
+    for(int c = 0; c < 7; c++) {
+        struct bench_corpus *corpus = &corpora[c];
+        corpus->name = names[c];
+        snprintf(corpus->dir, sizeof(corpus->dir), "%s/%s", work_dir, corpus->name);
+        snprintf(corpus->pack, sizeof(corpus->pack), "%s/%s.yep", work_dir, corpus->name);
+
+        // every corpus gets its own stream so adding one never changes the others
+        bench_rng_state = seed * 0x100000001B3ull + (uint64_t)c;
+
+        bool ok = false;
+        switch(c) {
+            case 0: ok = generate_tiny_text(corpus, quick ? 2000 : 20000); break;
+            case 1: ok = generate_large_binary(corpus, 4, quick ? (2u << 20) : (32u << 20)); break;
+            case 2: ok = generate_mixed(corpus, quick ? 64 : 512); break;
+            case 3: ok = generate_deep_tree(corpus, 12, quick ? 8 : 64); break;
+            case 4: ok = generate_lookup(corpus, 1000); break;
+            case 5: ok = generate_lookup(corpus, 10000); break;
+            case 6: ok = generate_lookup(corpus, 65000); break;
+        }
+        if(!ok || !bench_pack(corpus)) {
+            status = 1;
+            break;
+        }
+
+        size_t lookups = quick ? 200 : 2000;
+        if(c >= 4) {
+            bench_open(corpus, quick ? 20 : 100);
+            bench_lookup(corpus, lookups);
+        } else {
+            bench_extract(corpus);
+        }
+    }
+
+    fprintf(bench_out, "\n  ]\n}\n");
+    if(bench_out != stdout)
+        fclose(bench_out);
+
+    for(int c = 0; c < 7; c++)
+        corpus_free(&corpora[c]);
+
+    yep_shutdown();
+
+    if(!keep)
+        yep_recurse_delete_dir(work_dir);
+
+    return status;
+}
@@ -0,0 +1,34 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Subcommands of the yep cli, each takes the arguments following its name
+*/
+
+#ifndef YEP_CMD_H
+#define YEP_CMD_H
+
+#include <stdbool.h>
+
+int yep_cmd_bench(int argc, char **argv);
+int yep_cmd_list(int argc, char **argv);
+int yep_cmd_info(int argc, char **argv);
+int yep_cmd_extract(int argc, char **argv);
+int yep_cmd_serve(int argc, char **argv);
+int yep_cmd_mount(int argc, char **argv);
+
+// runs until interrupted, pack options must already be set with yep_set_pack_options()
+int yep_watch(const char *input_dir, const char *output_file);
+
+/*
+    Entry selection shared by the commands: a pattern is an exact name, a "dir/" prefix,
+    or a glob using * and ?. No patterns selects everything.
+*/
+bool yep_cmd_match(const char *name, int pattern_count, char **patterns);
+bool yep_cmd_glob(const char *pattern, const char *name);
+
+#endif // YEP_CMD_H
@@ -0,0 +1,309 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Shared between the libyep translation units, not part of the public API
+*/
+
+#ifndef YEP_INTERNAL_H
+#define YEP_INTERNAL_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    zlib helpers (libyep.c), both return 0 on success
+*/
+
+int compress_data(const char* input, size_t input_size, char** output, size_t* output_size);
+
+int decompress_data(const char* input, size_t input_size, char** output, size_t output_size);
+
+/*
+    Pack report (yepreport.c), collects per entry statistics while packing
+*/
+
+struct yep_report;
+
+struct yep_report *yep_report_create(void);
+
+void yep_report_add(struct yep_report *report, const char *name, uint32_t raw_size, uint32_t stored_size,
+                    uint8_t compression_type, uint8_t data_type, uint64_t compress_ns);
+
+bool yep_report_write(const struct yep_report *report, const char *path, const char *pack_path);
+
+void yep_report_free(struct yep_report *report);
+
+// writes value as a quoted and escaped JSON string
+void yep_write_json_string(FILE *file, const char *value);
+
+/*
+    Image stage (yepimage.c)
+*/
+
+bool yep_is_image_path(const char *name);
+
+uint8_t yep_image_mip_count(uint32_t width, uint32_t height, bool mips);
+
+size_t yep_image_payload_size(uint32_t width, uint32_t height, uint8_t mip_count);
+
+// decodes any format SDL_image understands into tightly packed RGBA8 (false without YEP_IMAGE_SUPPORT)
+bool yep_image_decode_rgba(const char *data, size_t size, uint8_t **pixels, uint32_t *width, uint32_t *height);
+
+// wraps RGBA8 pixels into an image payload (header + mips)
+bool yep_image_build(const uint8_t *rgba, uint32_t width, uint32_t height, bool mips, char **output, size_t *output_size);
+
+// decode + build
+bool yep_image_encode(const char *data, size_t size, bool mips, char **output, size_t *output_size);
+
+/*
+    Audio stage and PCM codec (yepaudio.c)
+*/
+
+bool yep_is_audio_path(const char *name);
+
+// decodes a wav file into an audio payload, false if it is not lossless as S16
+bool yep_audio_encode(const char *data, size_t size, char **output, size_t *output_size);
+
+// false if the input is not a well formed audio payload
+bool yep_lpc_compress(const char *input, size_t input_size, char **output, size_t *output_size);
+
+// same contract as decompress_data(), 0 on success
+int yep_lpc_decompress(const char *input, size_t input_size, char **output, size_t output_size);
+
+/*
+    Lua stage (yeplua.c)
+*/
+
+bool yep_is_lua_path(const char *name);
+
+// compiles a script to bytecode, stripped of debug info if strip is set (false without YEP_LUA_SUPPORT or on a syntax error)
+bool yep_lua_compile(const char *name, const char *data, size_t size, bool strip, char **output, size_t *output_size);
+
+/*
+    Animation stage (yepanim.c)
+*/
+
+// splits "dir/walk_012.png" into the length of "dir/walk_" and 12, false if the name has no frame number
+bool yep_animation_frame_name(const char *name, size_t *prefix_length, uint32_t *number);
+
+// bundles frame payloads into an animation payload, optionally delta encoding same sized image frames
+bool yep_animation_build(uint32_t frame_count, char **frames, const uint32_t *sizes, const uint8_t *data_types,
+                         bool delta, char **output, size_t *output_size);
+
+/*
+    Atlas stage (yepatlas.c)
+*/
+
+#define YEP_ATLAS_MAGIC 0x4C544159u // "YATL"
+
+struct yep_atlas_table_header {
+    uint32_t magic;
+    uint32_t page_count;
+    uint32_t region_count;
+    uint32_t reserved;
+};
+
+// followed by page_count page records, then region_count region records
+struct yep_atlas_page_record {
+    char name[64];              // entry holding the page image
+    uint32_t width;
+    uint32_t height;
+};
+
+struct yep_atlas_region_record {
+    char name[64];              // original handle of the image
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct yep_atlas_image {
+    const char *name;
+    uint8_t *pixels;            // RGBA8, tightly packed
+    uint32_t width;
+    uint32_t height;
+    uint32_t source;            // for the caller, left untouched
+
+    uint32_t page;              // filled in by yep_atlas_build()
+    uint32_t x;
+    uint32_t y;
+};
+
+struct yep_atlas_output {
+    uint32_t page_count;
+    char (*page_names)[64];
+    char **pages;               // image payloads
+    size_t *page_sizes;
+
+    char table_name[64];
+    char *table;
+    size_t table_size;
+};
+
+// packs images into pages named <prefix>atlas<n>.page plus a <prefix>atlas.table, false if a name does not fit
+bool yep_atlas_build(const char *prefix, struct yep_atlas_image *images, uint32_t count, uint32_t page_size, bool mips,
+                     struct yep_atlas_output *out);
+
+void yep_atlas_output_free(struct yep_atlas_output *out);
+
+// validates a table payload and its record counts
+bool yep_atlas_table_parse(const void *data, size_t size, struct yep_atlas_table_header *header);
+
+/*
+    Pixel filter (yepfilter.c)
+*/
+
+// filters the rows of an image payload and deflates the result, false if it is not a valid image
+bool yep_filter_compress(const char *input, size_t input_size, char **output, size_t *output_size);
+
+// same contract as decompress_data(), 0 on success
+int yep_filter_decompress(const char *input, size_t input_size, char **output, size_t output_size);
+
+/*
+    Loose directory backend (yeploose.c)
+*/
+
+struct yep_loose_file {
+    char name[64];
+    uint32_t size;
+    int64_t modify_time;
+};
+
+// lists every file under root sorted by name, and adds the directories to watch if it is not -1
+bool yep_loose_scan(const char *root, int watch, struct yep_loose_file **files, uint32_t *count);
+
+// -1 where change notification is not supported
+int yep_loose_watch_open(void);
+
+bool yep_loose_watch_changed(int watch);
+
+void yep_loose_watch_close(int watch);
+
+// reads root/name into the heap, null terminated
+char *yep_loose_read(const char *root, const char *name, size_t *size);
+
+/*
+    Shared memory index and cache (yepshared.c)
+*/
+
+struct yep_entry;
+struct yep_shared;
+
+// where the index of a pack lives inside its segment
+struct yep_shared_index {
+    struct yep_entry *entries;
+    uint64_t *hashes;
+    uint32_t *buckets;
+    uint32_t bucket_mask;
+    uint64_t fingerprint;
+    bool ready;                 // false if the caller created the segment and has to fill and publish it
+};
+
+// opens or creates the segment of one version of a pack, NULL means use a private index
+struct yep_shared *yep_shared_open(const char *path, uint64_t identity, uint16_t entry_count, uint32_t bucket_count,
+                                   size_t cache_size, struct yep_shared_index *index);
+
+// marks the index as filled in, waiting processes start using it
+void yep_shared_publish(struct yep_shared *shared, uint64_t fingerprint);
+
+// the decoded copy of entry index, NULL if nobody stored one yet
+const void *yep_shared_cache_get(const struct yep_shared *shared, uint32_t index, size_t *size);
+
+// stores the decoded copy of entry index, NULL if another process is storing it or the cache is full
+const void *yep_shared_cache_put(const struct yep_shared *shared, uint32_t index, const void *data, size_t size);
+
+void yep_shared_close(struct yep_shared *shared);
+
+// removes the segment name, processes that have it mapped keep using it
+bool yep_shared_unlink(const char *path, uint64_t identity);
+
+/*
+    Asset server protocol (yepclient.c, cmd_serve.c)
+
+    One fixed size request per extraction over a Unix stream socket, answered with one
+    fixed size response. On success the payload is passed along with it as a file
+    descriptor, at offset.
+*/
+
+#define YEP_SERVE_MAGIC 0x56524559u // "YERV"
+#define YEP_SERVE_VERSION 1
+
+enum yep_serve_status {
+    YEP_SERVE_OK = 0,
+    YEP_SERVE_BAD_REQUEST,
+    YEP_SERVE_NO_PACK,
+    YEP_SERVE_NO_ENTRY,
+    YEP_SERVE_FAILED,
+};
+
+struct yep_serve_request {
+    uint32_t magic;
+    uint32_t version;
+    char pack[4096];            // absolute path
+    char handle[64];
+};
+
+struct yep_serve_response {
+    uint32_t status;            // enum yep_serve_status
+    uint32_t data_type;
+    uint64_t offset;            // of the payload inside the passed file
+    uint64_t size;
+};
+
+/*
+    Incremental packing (yepcache.c)
+*/
+
+struct yep_pack_options;
+struct yep_header_node;
+struct yep_cache;
+
+// an entry copied as stored from the previous pack, see yep_copy_range()
+struct yep_cache_entry {
+    FILE *source;               // the previous pack, open until yep_cache_close()
+    uint64_t offset;
+    uint32_t size;
+    uint32_t uncompressed_size;
+    uint8_t compression_type;
+    uint8_t data_type;
+};
+
+uint64_t yep_cache_options_key(const struct yep_pack_options *options);
+
+struct yep_stat_cache;
+
+// reads the cache and opens the pack it describes, never NULL. Source files are looked up in
+// stats (see yepfs.h), which has to outlive the cache
+struct yep_cache *yep_cache_open(const char *cache_path, const char *pack_path, uint64_t options_key, struct yep_stat_cache *stats);
+
+// records the source of a plain file entry, true if its previous stored bytes can be reused
+bool yep_cache_lookup(struct yep_cache *cache, const struct yep_header_node *node, struct yep_cache_entry *out);
+
+uint32_t yep_cache_hits(const struct yep_cache *cache);
+
+// writes the records collected by yep_cache_lookup() for the pack just written
+bool yep_cache_save(const struct yep_cache *cache, const char *cache_path, const char *pack_path);
+
+void yep_cache_close(struct yep_cache *cache);
+
+struct yep_depfile;
+
+struct yep_depfile *yep_depfile_create(void);
+
+void yep_depfile_add(struct yep_depfile *depfile, const char *path);
+
+// writes "<target>: <paths...>" in Make syntax
+bool yep_depfile_write(const struct yep_depfile *depfile, const char *depfile_path, const char *target);
+
+void yep_depfile_free(struct yep_depfile *depfile);
+
+#endif // YEP_INTERNAL_H
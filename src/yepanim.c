@@ -0,0 +1,196 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Animation payloads (YEP_DATATYPE_ANIMATION)
+
+    A numbered frame sequence (walk_000.png, walk_001.png, ...) is folded into one entry:
+    a yep_animation_header, a frame table, then every frame payload in order. Frames that
+    are decoded images of the same size as the previous frame can be stored as the XOR
+    against it, which turns unchanged pixels into zeros that compress to almost nothing.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define YEP_ANIMATION_FRAME_ALIGNMENT 8
+
+static size_t table_end(uint32_t frame_count) {
+    return sizeof(struct yep_animation_header) + (size_t)frame_count * sizeof(struct yep_animation_frame);
+}
+
+static bool read_header(const void *data, size_t size, struct yep_animation_header *header) {
+    if(data == NULL || size < sizeof(*header))
+        return false;
+
+    memcpy(header, data, sizeof(*header));
+    if(header->magic != YEP_ANIMATION_MAGIC || table_end(header->frame_count) > size) {
+        yep_logf(yep_log_error, "Invalid yep animation header\n");
+        return false;
+    }
+    return true;
+}
+
+static void read_frame(const void *data, uint32_t index, struct yep_animation_frame *frame) {
+    memcpy(frame, (const uint8_t *)data + table_end(index), sizeof(*frame));
+}
+
+bool yep_animation_parse(const void *data, size_t size, struct yep_animation *out) {
+    struct yep_animation_header header;
+    if(!read_header(data, size, &header))
+        return false;
+
+    for(uint32_t i = 0; i < header.frame_count; i++) {
+        struct yep_animation_frame frame;
+        read_frame(data, i, &frame);
+
+        if((size_t)frame.offset + frame.size > size) {
+            yep_logf(yep_log_error, "Truncated yep animation payload\n");
+            return false;
+        }
+        if(frame.flags & YEP_ANIMATION_FRAME_DELTA) {
+            yep_logf(yep_log_error, "Animation frames are still delta encoded, resolve them with yep_animation_resolve()\n");
+            return false;
+        }
+    }
+
+    out->frame_count = header.frame_count;
+    out->payload = data;
+    out->size = size;
+    return true;
+}
+
+const void *yep_animation_frame_data(const struct yep_animation *animation, uint32_t index, size_t *size, uint8_t *data_type) {
+    if(index >= animation->frame_count)
+        return NULL;
+
+    struct yep_animation_frame frame;
+    read_frame(animation->payload, index, &frame);
+
+    *size = frame.size;
+    if(data_type != NULL)
+        *data_type = frame.data_type;
+    return (const uint8_t *)animation->payload + frame.offset;
+}
+
+bool yep_animation_resolve(void *data, size_t size) {
+    struct yep_animation_header header;
+    if(!read_header(data, size, &header))
+        return false;
+
+    uint8_t *bytes = data;
+    struct yep_animation_frame previous = {0};
+
+    for(uint32_t i = 0; i < header.frame_count; i++) {
+        struct yep_animation_frame frame;
+        read_frame(data, i, &frame);
+
+        if((size_t)frame.offset + frame.size > size) {
+            yep_logf(yep_log_error, "Truncated yep animation payload\n");
+            return false;
+        }
+
+        // frames resolve in order, so the previous frame is already plain
+        if(frame.flags & YEP_ANIMATION_FRAME_DELTA) {
+            if(i == 0 || frame.size != previous.size) {
+                yep_logf(yep_log_error, "Invalid delta frame %u in animation\n", i);
+                return false;
+            }
+
+            for(uint32_t b = 0; b < frame.size; b++)
+                bytes[frame.offset + b] ^= bytes[previous.offset + b];
+
+            frame.flags &= (uint8_t)~YEP_ANIMATION_FRAME_DELTA;
+            memcpy(bytes + table_end(i), &frame, sizeof(frame));
+        }
+
+        previous = frame;
+    }
+
+    return true;
+}
+
+/*
+    ================================= PACK STAGE =================================
+*/
+
+bool yep_animation_frame_name(const char *name, size_t *prefix_length, uint32_t *number) {
+    const char *base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+
+    const char *dot = strrchr(base, '.');
+    if(dot == NULL)
+        return false;
+
+    const char *digits = dot;
+    while(digits > base && isdigit((unsigned char)digits[-1]))
+        digits--;
+
+    if(digits == dot || dot - digits > 9)
+        return false;
+
+    *prefix_length = (size_t)(digits - name);
+    *number = (uint32_t)strtoul(digits, NULL, 10);
+    return true;
+}
+
+bool yep_animation_build(uint32_t frame_count, char **frames, const uint32_t *sizes, const uint8_t *data_types,
+                         bool delta, char **output, size_t *output_size) {
+    size_t size = table_end(frame_count);
+    for(uint32_t i = 0; i < frame_count; i++) {
+        size = (size + YEP_ANIMATION_FRAME_ALIGNMENT - 1) & ~(size_t)(YEP_ANIMATION_FRAME_ALIGNMENT - 1);
+        size += sizes[i];
+    }
+
+    if(size > UINT32_MAX)
+        return false;
+
+    uint8_t *payload = calloc(1, size);
+    if(payload == NULL)
+        return false;
+
+    struct yep_animation_header header = {
+        .magic = YEP_ANIMATION_MAGIC,
+        .frame_count = frame_count,
+        .reserved = 0,
+    };
+    memcpy(payload, &header, sizeof(header));
+
+    size_t offset = table_end(frame_count);
+    for(uint32_t i = 0; i < frame_count; i++) {
+        offset = (offset + YEP_ANIMATION_FRAME_ALIGNMENT - 1) & ~(size_t)(YEP_ANIMATION_FRAME_ALIGNMENT - 1);
+
+        struct yep_animation_frame frame = {
+            .offset = (uint32_t)offset,
+            .size = sizes[i],
+            .data_type = data_types[i],
+            .flags = 0,
+            .reserved = 0,
+        };
+
+        memcpy(payload + offset, frames[i], sizes[i]);
+
+        // only raw pixels line up byte for byte, encoded files would just get noisier
+        if(delta && i > 0 && data_types[i] == YEP_DATATYPE_IMAGE && data_types[i - 1] == YEP_DATATYPE_IMAGE && sizes[i] == sizes[i - 1]) {
+            for(uint32_t b = 0; b < sizes[i]; b++)
+                payload[offset + b] ^= (uint8_t)frames[i - 1][b];
+            frame.flags |= YEP_ANIMATION_FRAME_DELTA;
+        }
+
+        memcpy(payload + table_end(i), &frame, sizeof(frame));
+        offset += sizes[i];
+    }
+
+    *output = (char *)payload;
+    *output_size = size;
+    return true;
+}
@@ -0,0 +1,205 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Texture atlases (YEP_DATATYPE_ATLAS)
+
+    Small images of one directory are shelf packed into a few atlas pages, which are
+    stored as regular image entries (<dir>/atlas0.page, ...). A table entry
+    (<dir>/atlas.table) maps every original handle to its page and pixel rectangle,
+    and yep_pack_find_region() resolves handles through it.
+
+    Every image gets a one pixel border copied from its edges, so filtering at the
+    region edge never samples a neighbour.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define YEP_ATLAS_BORDER 1
+
+static struct yep_atlas_image *sort_images;
+
+// tallest first keeps shelves tight, ties broken by name so packing is deterministic
+static int compare_heights(const void *a, const void *b) {
+    const struct yep_atlas_image *x = &sort_images[*(const uint32_t *)a];
+    const struct yep_atlas_image *y = &sort_images[*(const uint32_t *)b];
+
+    if(x->height != y->height)
+        return x->height > y->height ? -1 : 1;
+    if(x->width != y->width)
+        return x->width > y->width ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+static uint32_t shelf_pack(struct yep_atlas_image *images, uint32_t count, uint32_t page_size,
+                           uint32_t *page_widths, uint32_t *page_heights) {
+    uint32_t *order = malloc(count * sizeof(uint32_t));
+    for(uint32_t i = 0; i < count; i++)
+        order[i] = i;
+
+    sort_images = images;
+    qsort(order, count, sizeof(uint32_t), compare_heights);
+
+    uint32_t page = 0;
+    uint32_t cursor_x = 0, shelf_y = 0, shelf_height = 0;
+    page_widths[0] = page_heights[0] = 0;
+
+    for(uint32_t i = 0; i < count; i++) {
+        struct yep_atlas_image *image = &images[order[i]];
+        uint32_t cell_width = image->width + 2 * YEP_ATLAS_BORDER;
+        uint32_t cell_height = image->height + 2 * YEP_ATLAS_BORDER;
+
+        if(cursor_x + cell_width > page_size) {
+            shelf_y += shelf_height;
+            cursor_x = 0;
+            shelf_height = 0;
+        }
+        if(shelf_y + cell_height > page_size) {
+            page++;
+            page_widths[page] = page_heights[page] = 0;
+            cursor_x = shelf_y = shelf_height = 0;
+        }
+
+        image->page = page;
+        image->x = cursor_x + YEP_ATLAS_BORDER;
+        image->y = shelf_y + YEP_ATLAS_BORDER;
+
+        cursor_x += cell_width;
+        if(cell_height > shelf_height)
+            shelf_height = cell_height;
+
+        // pages are trimmed to what they actually use
+        if(cursor_x > page_widths[page])
+            page_widths[page] = cursor_x;
+        if(shelf_y + shelf_height > page_heights[page])
+            page_heights[page] = shelf_y + shelf_height;
+    }
+
+    free(order);
+    return page + 1;
+}
+
+static void blit_extruded(uint8_t *page, uint32_t page_width, const struct yep_atlas_image *image) {
+    for(uint32_t y = 0; y < image->height; y++)
+        memcpy(page + ((size_t)(image->y + y) * page_width + image->x) * 4, image->pixels + (size_t)y * image->width * 4, (size_t)image->width * 4);
+
+    // top and bottom border rows, then the side columns including the corners
+    size_t row_bytes = (size_t)image->width * 4;
+    memcpy(page + ((size_t)(image->y - 1) * page_width + image->x) * 4, page + ((size_t)image->y * page_width + image->x) * 4, row_bytes);
+    memcpy(page + ((size_t)(image->y + image->height) * page_width + image->x) * 4,
+           page + ((size_t)(image->y + image->height - 1) * page_width + image->x) * 4, row_bytes);
+
+    for(uint32_t y = image->y - 1; y <= image->y + image->height; y++) {
+        uint8_t *row = page + (size_t)y * page_width * 4;
+        memcpy(row + (size_t)(image->x - 1) * 4, row + (size_t)image->x * 4, 4);
+        memcpy(row + (size_t)(image->x + image->width) * 4, row + (size_t)(image->x + image->width - 1) * 4, 4);
+    }
+}
+
+bool yep_atlas_build(const char *prefix, struct yep_atlas_image *images, uint32_t count, uint32_t page_size, bool mips,
+                     struct yep_atlas_output *out) {
+    memset(out, 0, sizeof(*out));
+
+    if(snprintf(out->table_name, sizeof(out->table_name), "%satlas.table", prefix) >= (int)sizeof(out->table_name))
+        return false;
+
+    // worst case is a page per image
+    uint32_t *page_widths = malloc(count * sizeof(uint32_t));
+    uint32_t *page_heights = malloc(count * sizeof(uint32_t));
+    uint32_t page_count = shelf_pack(images, count, page_size, page_widths, page_heights);
+
+    out->page_count = page_count;
+    out->page_names = calloc(page_count, sizeof(*out->page_names));
+    out->pages = calloc(page_count, sizeof(char *));
+    out->page_sizes = calloc(page_count, sizeof(size_t));
+
+    bool ok = true;
+    for(uint32_t page = 0; page < page_count && ok; page++) {
+        if(snprintf(out->page_names[page], sizeof(out->page_names[page]), "%satlas%u.page", prefix, page) >= (int)sizeof(out->page_names[page])) {
+            ok = false;
+            break;
+        }
+
+        uint8_t *pixels = calloc((size_t)page_widths[page] * page_heights[page], 4);
+        for(uint32_t i = 0; i < count; i++) {
+            if(images[i].page == page)
+                blit_extruded(pixels, page_widths[page], &images[i]);
+        }
+
+        ok = yep_image_build(pixels, page_widths[page], page_heights[page], mips, &out->pages[page], &out->page_sizes[page]);
+        free(pixels);
+    }
+
+    if(ok) {
+        struct yep_atlas_table_header header = {
+            .magic = YEP_ATLAS_MAGIC,
+            .page_count = page_count,
+            .region_count = count,
+            .reserved = 0,
+        };
+
+        out->table_size = sizeof(header) + (size_t)page_count * sizeof(struct yep_atlas_page_record) +
+                          (size_t)count * sizeof(struct yep_atlas_region_record);
+        out->table = calloc(1, out->table_size);
+
+        char *cursor = out->table;
+        memcpy(cursor, &header, sizeof(header));
+        cursor += sizeof(header);
+
+        for(uint32_t page = 0; page < page_count; page++) {
+            struct yep_atlas_page_record record = { .width = page_widths[page], .height = page_heights[page] };
+            memcpy(record.name, out->page_names[page], sizeof(record.name));
+            memcpy(cursor, &record, sizeof(record));
+            cursor += sizeof(record);
+        }
+
+        for(uint32_t i = 0; i < count; i++) {
+            struct yep_atlas_region_record record = {
+                .page = images[i].page,
+                .x = images[i].x,
+                .y = images[i].y,
+                .width = images[i].width,
+                .height = images[i].height,
+            };
+            snprintf(record.name, sizeof(record.name), "%s", images[i].name);
+            memcpy(cursor, &record, sizeof(record));
+            cursor += sizeof(record);
+        }
+    }
+
+    free(page_widths);
+    free(page_heights);
+
+    if(!ok)
+        yep_atlas_output_free(out);
+    return ok;
+}
+
+void yep_atlas_output_free(struct yep_atlas_output *out) {
+    for(uint32_t page = 0; out->pages != NULL && page < out->page_count; page++)
+        free(out->pages[page]);
+    free(out->pages);
+    free(out->page_sizes);
+    free(out->page_names);
+    free(out->table);
+    memset(out, 0, sizeof(*out));
+}
+
+bool yep_atlas_table_parse(const void *data, size_t size, struct yep_atlas_table_header *header) {
+    if(size < sizeof(*header))
+        return false;
+
+    memcpy(header, data, sizeof(*header));
+    return header->magic == YEP_ATLAS_MAGIC &&
+           sizeof(*header) + (size_t)header->page_count * sizeof(struct yep_atlas_page_record) +
+           (size_t)header->region_count * sizeof(struct yep_atlas_region_record) <= size;
+}
@@ -0,0 +1,410 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Audio payloads (YEP_DATATYPE_PCM) and the lossless PCM codec (YEP_COMPRESSION_LPC)
+
+    At pack time audio is decoded with SDL into interleaved signed 16 bit samples behind a
+    small yep_audio_header. Instead of deflate, those payloads are compressed by predicting
+    every sample from the previous ones of the same channel (fixed polynomial predictors,
+    order 0-3, picked per block) and rice coding the residuals. This is the same idea FLAC
+    and Shorten use, and decodes in a single cheap pass straight into mixer ready samples.
+
+    Compressed layout:
+        yep_audio_header (copied verbatim)
+        for each block of YEP_LPC_BLOCK_FRAMES frames, for each channel:
+            2 bits  predictor order
+            5 bits  rice parameter
+            4 bits  wasted low bits (zero in every sample, ie: audio widened from 8 bit)
+            rice coded residual per frame, of the samples shifted down by the wasted bits
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include <SDL3/SDL.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define YEP_LPC_BLOCK_FRAMES 4096
+#define YEP_LPC_MAX_ORDER 3
+#define YEP_LPC_ESCAPE 32       // unary quotients this long are followed by the raw 32 bit value
+
+bool yep_audio_parse(const void *data, size_t size, struct yep_audio *out) {
+    if(data == NULL || size < sizeof(struct yep_audio_header))
+        return false;
+
+    struct yep_audio_header header;
+    memcpy(&header, data, sizeof(header));
+
+    if(header.magic != YEP_AUDIO_MAGIC || header.format != YEP_SAMPLE_FORMAT_S16 || header.channels == 0) {
+        yep_logf(yep_log_error, "Invalid yep audio header\n");
+        return false;
+    }
+
+    size_t bytes = (size_t)header.frame_count * header.channels * sizeof(int16_t);
+    if(bytes > size - sizeof(struct yep_audio_header)) {
+        yep_logf(yep_log_error, "Truncated yep audio payload\n");
+        return false;
+    }
+
+    out->frequency = header.frequency;
+    out->channels = header.channels;
+    out->format = header.format;
+    out->frame_count = header.frame_count;
+    out->samples = (const int16_t *)((const uint8_t *)data + sizeof(struct yep_audio_header));
+    return true;
+}
+
+/*
+    ================================= PACK STAGE =================================
+*/
+
+bool yep_is_audio_path(const char *name) {
+    const char *dot = strrchr(name, '.');
+    if(dot == NULL || strchr(dot, '/') != NULL)
+        return false;
+
+    char extension[8];
+    size_t i = 0;
+    for(dot++; *dot && i + 1 < sizeof(extension); dot++)
+        extension[i++] = (char)tolower((unsigned char)*dot);
+    extension[i] = '\0';
+
+    // SDL only decodes wav on its own, compressed formats are left for the mixer
+    return strcmp(extension, "wav") == 0;
+}
+
+bool yep_audio_encode(const char *data, size_t size, char **output, size_t *output_size) {
+    SDL_IOStream *stream = SDL_IOFromConstMem(data, size);
+    if(stream == NULL)
+        return false;
+
+    SDL_AudioSpec spec;
+    Uint8 *samples;
+    Uint32 sample_bytes;
+    if(!SDL_LoadWAV_IO(stream, true, &spec, &samples, &sample_bytes)) {
+        yep_logf(yep_log_warning, "SDL could not decode audio: %s\n", SDL_GetError());
+        return false;
+    }
+
+    // widening 8 bit or byte swapping 16 bit audio is lossless, anything wider would not be
+    if(SDL_AUDIO_BITSIZE(spec.format) > 16) {
+        yep_logf(yep_log_debug, "Keeping %d bit audio as-is\n", SDL_AUDIO_BITSIZE(spec.format));
+        SDL_free(samples);
+        return false;
+    }
+
+    if(spec.format != SDL_AUDIO_S16LE) {
+        SDL_AudioSpec target = spec;
+        target.format = SDL_AUDIO_S16LE;
+
+        Uint8 *converted;
+        int converted_bytes;
+        bool ok = SDL_ConvertAudioSamples(&spec, samples, (int)sample_bytes, &target, &converted, &converted_bytes);
+        SDL_free(samples);
+        if(!ok) {
+            yep_logf(yep_log_warning, "Could not convert audio to S16: %s\n", SDL_GetError());
+            return false;
+        }
+        samples = converted;
+        sample_bytes = (Uint32)converted_bytes;
+    }
+
+    struct yep_audio_header header = {
+        .magic = YEP_AUDIO_MAGIC,
+        .frequency = (uint32_t)spec.freq,
+        .frame_count = sample_bytes / ((uint32_t)spec.channels * sizeof(int16_t)),
+        .channels = (uint8_t)spec.channels,
+        .format = YEP_SAMPLE_FORMAT_S16,
+        .reserved = 0,
+    };
+
+    size_t pcm_bytes = (size_t)header.frame_count * header.channels * sizeof(int16_t);
+    *output_size = sizeof(header) + pcm_bytes;
+    *output = malloc(*output_size);
+    memcpy(*output, &header, sizeof(header));
+    memcpy(*output + sizeof(header), samples, pcm_bytes);
+
+    SDL_free(samples);
+    return true;
+}
+
+/*
+    ================================= LPC CODEC ==================================
+*/
+
+struct bit_writer {
+    uint8_t *data;
+    size_t capacity;
+    size_t size;
+    uint64_t buffer;
+    int bits;
+};
+
+static void put_bits(struct bit_writer *writer, uint32_t value, int count) {
+    // count <= 32, so the buffer never holds more than 39 bits before flushing
+    writer->buffer = (writer->buffer << count) | (value & (uint32_t)((1ull << count) - 1));
+    writer->bits += count;
+
+    while(writer->bits >= 8) {
+        if(writer->size == writer->capacity) {
+            writer->capacity *= 2;
+            writer->data = realloc(writer->data, writer->capacity);
+        }
+        writer->bits -= 8;
+        writer->data[writer->size++] = (uint8_t)(writer->buffer >> writer->bits);
+    }
+}
+
+static void put_rice(struct bit_writer *writer, uint32_t value, int k) {
+    uint32_t quotient = value >> k;
+
+    if(quotient >= YEP_LPC_ESCAPE) {
+        put_bits(writer, UINT32_MAX, YEP_LPC_ESCAPE);
+        put_bits(writer, value, 32);
+        return;
+    }
+
+    // quotient ones then a terminating zero
+    put_bits(writer, ((1u << quotient) - 1) << 1, (int)quotient + 1);
+    if(k > 0)
+        put_bits(writer, value, k);
+}
+
+struct bit_reader {
+    const uint8_t *data;
+    size_t size;
+    size_t position;
+    uint64_t buffer;
+    int bits;
+};
+
+static void refill(struct bit_reader *reader) {
+    while(reader->bits <= 56) {
+        uint8_t byte = reader->position < reader->size ? reader->data[reader->position] : 0;
+        reader->position++;
+        reader->buffer |= (uint64_t)byte << (56 - reader->bits);
+        reader->bits += 8;
+    }
+}
+
+static uint32_t get_bits(struct bit_reader *reader, int count) {
+    if(reader->bits < count)
+        refill(reader);
+
+    uint32_t value = (uint32_t)(reader->buffer >> (64 - count));
+    reader->buffer <<= count;
+    reader->bits -= count;
+    return value;
+}
+
+static uint32_t get_rice(struct bit_reader *reader, int k) {
+    if(reader->bits < YEP_LPC_ESCAPE + 1)
+        refill(reader);
+
+    // the buffer is never empty here, so counting leading ones is well defined
+    uint32_t quotient = 0;
+    while(quotient < YEP_LPC_ESCAPE && (reader->buffer & (1ull << 63))) {
+        reader->buffer <<= 1;
+        reader->bits--;
+        quotient++;
+    }
+
+    if(quotient == YEP_LPC_ESCAPE)
+        return get_bits(reader, 32);
+
+    // skip the terminating zero
+    reader->buffer <<= 1;
+    reader->bits--;
+
+    return k > 0 ? (quotient << k) | get_bits(reader, k) : quotient;
+}
+
+static inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// fixed polynomial predictors, history[0] is the previous sample. Computed in 64 bits so a
+// corrupt stream cannot overflow them, the decoder range checks what comes out
+static inline int64_t predict(int order, const int32_t history[YEP_LPC_MAX_ORDER]) {
+    switch(order) {
+        case 1:  return history[0];
+        case 2:  return 2 * (int64_t)history[0] - history[1];
+        case 3:  return 3 * (int64_t)history[0] - 3 * (int64_t)history[1] + history[2];
+        default: return 0;
+    }
+}
+
+static inline void push_history(int32_t history[YEP_LPC_MAX_ORDER], int32_t sample) {
+    history[2] = history[1];
+    history[1] = history[0];
+    history[0] = sample;
+}
+
+static int rice_parameter(uint64_t residual_sum, uint32_t count) {
+    uint64_t mean = count ? residual_sum / count : 0;
+    int k = 0;
+    while(k < 30 && (mean >> k) > 0)
+        k++;
+    return k;
+}
+
+bool yep_lpc_compress(const char *input, size_t input_size, char **output, size_t *output_size) {
+    struct yep_audio audio;
+    if(!yep_audio_parse(input, input_size, &audio) ||
+       input_size != sizeof(struct yep_audio_header) + (size_t)audio.frame_count * audio.channels * sizeof(int16_t))
+        return false;
+
+    struct bit_writer writer = {
+        .capacity = input_size / 2 + 64,
+    };
+    writer.data = malloc(writer.capacity);
+
+    // the header is copied verbatim so the decoder knows the layout
+    for(size_t i = 0; i < sizeof(struct yep_audio_header); i++)
+        put_bits(&writer, (uint8_t)input[i], 8);
+
+    int32_t (*history)[YEP_LPC_MAX_ORDER] = calloc(audio.channels, sizeof(*history));
+
+    for(uint32_t block = 0; block < audio.frame_count; block += YEP_LPC_BLOCK_FRAMES) {
+        uint32_t frames = audio.frame_count - block < YEP_LPC_BLOCK_FRAMES ? audio.frame_count - block : YEP_LPC_BLOCK_FRAMES;
+
+        for(uint8_t channel = 0; channel < audio.channels; channel++) {
+            const int16_t *samples = audio.samples + (size_t)block * audio.channels + channel;
+
+            uint32_t used_bits = 0;
+            for(uint32_t i = 0; i < frames; i++)
+                used_bits |= (uint16_t)samples[(size_t)i * audio.channels];
+
+            int shift = 0;
+            while(shift < 15 && used_bits != 0 && (used_bits & (1u << shift)) == 0)
+                shift++;
+
+            // history is kept at the original scale, so it stays valid when the shift changes
+            int32_t scaled[YEP_LPC_MAX_ORDER];
+            for(int h = 0; h < YEP_LPC_MAX_ORDER; h++)
+                scaled[h] = history[channel][h] >> shift;
+
+            // pick the order with the smallest residual magnitude for this block
+            uint64_t cost[YEP_LPC_MAX_ORDER + 1] = {0};
+            int32_t scratch[YEP_LPC_MAX_ORDER];
+            memcpy(scratch, scaled, sizeof(scratch));
+            for(uint32_t i = 0; i < frames; i++) {
+                int32_t sample = samples[(size_t)i * audio.channels] >> shift;
+                for(int order = 0; order <= YEP_LPC_MAX_ORDER; order++)
+                    cost[order] += zigzag((int32_t)(sample - predict(order, scratch)));
+                push_history(scratch, sample);
+            }
+
+            int best = 0;
+            for(int order = 1; order <= YEP_LPC_MAX_ORDER; order++) {
+                if(cost[order] < cost[best])
+                    best = order;
+            }
+
+            int k = rice_parameter(cost[best], frames);
+            put_bits(&writer, (uint32_t)best, 2);
+            put_bits(&writer, (uint32_t)k, 5);
+            put_bits(&writer, (uint32_t)shift, 4);
+
+            for(uint32_t i = 0; i < frames; i++) {
+                int32_t sample = samples[(size_t)i * audio.channels];
+                put_rice(&writer, zigzag((int32_t)((sample >> shift) - predict(best, scaled))), k);
+                push_history(scaled, sample >> shift);
+                push_history(history[channel], sample);
+            }
+        }
+    }
+
+    // pad out the final byte
+    if(writer.bits > 0)
+        put_bits(&writer, 0, 8 - writer.bits);
+
+    free(history);
+
+    *output = (char *)writer.data;
+    *output_size = writer.size;
+    return true;
+}
+
+int yep_lpc_decompress(const char *input, size_t input_size, char **output, size_t output_size) {
+    struct yep_audio_header header;
+    if(input_size < sizeof(header) || output_size < sizeof(header))
+        return -1;
+    memcpy(&header, input, sizeof(header));
+
+    if(header.magic != YEP_AUDIO_MAGIC || header.channels == 0 ||
+       output_size != sizeof(header) + (size_t)header.frame_count * header.channels * sizeof(int16_t)) {
+        yep_logf(yep_log_error, "Error: corrupt lpc stream\n");
+        return -1;
+    }
+
+    *output = malloc(output_size);
+    memcpy(*output, &header, sizeof(header));
+    int16_t *samples = (int16_t *)(*output + sizeof(header));
+
+    struct bit_reader reader = {
+        .data = (const uint8_t *)input + sizeof(header),
+        .size = input_size - sizeof(header),
+    };
+
+    int32_t (*history)[YEP_LPC_MAX_ORDER] = calloc(header.channels, sizeof(*history));
+    bool valid = true;
+
+    for(uint32_t block = 0; block < header.frame_count && valid; block += YEP_LPC_BLOCK_FRAMES) {
+        uint32_t frames = header.frame_count - block < YEP_LPC_BLOCK_FRAMES ? header.frame_count - block : YEP_LPC_BLOCK_FRAMES;
+
+        for(uint8_t channel = 0; channel < header.channels && valid; channel++) {
+            int order = (int)get_bits(&reader, 2);
+            int k = (int)get_bits(&reader, 5);
+            int shift = (int)get_bits(&reader, 4);
+            int16_t *out = samples + (size_t)block * header.channels + channel;
+
+            int32_t scaled[YEP_LPC_MAX_ORDER];
+            for(int h = 0; h < YEP_LPC_MAX_ORDER; h++)
+                scaled[h] = history[channel][h] >> shift;
+
+            for(uint32_t i = 0; i < frames; i++) {
+                // every sample the encoder wrote fits 16 bits once shifted back
+                int64_t value = predict(order, scaled) + unzigzag(get_rice(&reader, k));
+                int64_t sample = value * ((int64_t)1 << shift);
+                if(sample < INT16_MIN || sample > INT16_MAX) {
+                    valid = false;
+                    break;
+                }
+                out[(size_t)i * header.channels] = (int16_t)sample;
+                push_history(scaled, (int32_t)value);
+                push_history(history[channel], (int32_t)sample);
+            }
+        }
+    }
+
+    free(history);
+
+    if(!valid) {
+        yep_logf(yep_log_error, "Error: corrupt lpc stream, sample out of range\n");
+        free(*output);
+        return -1;
+    }
+
+    // reading past the end pads with zeros, so a short stream only shows up here
+    if(reader.position - (size_t)(reader.bits / 8) > reader.size) {
+        yep_logf(yep_log_error, "Error: truncated lpc stream\n");
+        free(*output);
+        return -1;
+    }
+
+    return 0;
+}
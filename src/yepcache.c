@@ -0,0 +1,355 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Incremental packing, used when yep_pack_options.cache_path / depfile_path are set.
+
+    The cache file remembers the modification time and size every source file had when
+    the pack next to it was written. On the next pack, entries whose source did not change
+    are copied out of the previous pack as stored (already decoded and compressed), so
+    only edited files go through the stages again. The new pack is written next to the
+    old one and renamed over it, so the copies are made file to file (see yep_copy_range()).
+    The cache is thrown away if the pack was rewritten by something else or was made with
+    different options.
+
+    The depfile lists every file and directory the pack was built from in Make syntax, so
+    Ninja and Make rerun the pack when a file is edited, added or removed.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "yepfs.h"
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define YEP_CACHE_MAGIC 0x43504559u // "YEPC"
+#define YEP_CACHE_VERSION 1
+
+struct yep_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t options_key;       // see yep_cache_open()
+    uint64_t table_hash;        // header table of the pack this cache describes
+    uint32_t record_count;
+    uint32_t reserved;
+};
+
+// one per plain source file, sorted by name
+struct yep_cache_record {
+    char name[64];
+    int64_t modify_time;
+    uint64_t size;
+};
+
+struct yep_cache {
+    const void *pack_data;      // mapping of the previous pack, for its index
+    size_t pack_size;
+    FILE *pack_file;            // same file, entries are copied out of it
+    struct yep_pack *pack;
+
+    uint64_t options_key;
+    struct yep_stat_cache *stats;   // shared with the walk, see yep_cache_open()
+
+    struct yep_cache_record *old_records;
+    uint32_t old_count;
+
+    struct yep_cache_record *records;
+    uint32_t count;
+    uint32_t capacity;
+
+    uint32_t hits;
+};
+
+// FNV-1a over the header table, which changes with any offset, size or type
+static uint64_t table_hash(const uint8_t *data, size_t size) {
+    if(size < 3)
+        return 0;
+
+    uint16_t entry_count;
+    memcpy(&entry_count, data + 1, sizeof(uint16_t));
+
+    size_t table_size = 3 + (size_t)entry_count * YEP_HEADER_SIZE_BYTES;
+    if(table_size > size)
+        return 0;
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < table_size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+        return NULL;
+
+    fseek(file, 0L, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0L, SEEK_SET);
+
+    char *data = length > 0 ? malloc((size_t)length) : NULL;
+    if(data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+static int compare_records(const void *a, const void *b) {
+    return strcmp(((const struct yep_cache_record *)a)->name, ((const struct yep_cache_record *)b)->name);
+}
+
+// everything that changes what a single file turns into
+uint64_t yep_cache_options_key(const struct yep_pack_options *options) {
+    uint8_t key[] = {
+        YEP_CURRENT_FORMAT_VERSION,
+        options->decode_images,
+        options->image_mips,
+        options->decode_audio,
+        options->compile_lua,
+        options->lua_debug_info,
+    };
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < sizeof(key); i++) {
+        hash ^= key[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+struct yep_cache *yep_cache_open(const char *cache_path, const char *pack_path, uint64_t options_key, struct yep_stat_cache *stats) {
+    struct yep_cache *cache = calloc(1, sizeof(struct yep_cache));
+    cache->options_key = options_key;
+    cache->stats = stats;
+
+    size_t cache_size;
+    char *cache_data = read_file(cache_path, &cache_size);
+    if(cache_data == NULL) {
+        yep_logf(yep_log_debug,"No pack cache at %s, packing everything\n", cache_path);
+        return cache;
+    }
+
+    struct yep_cache_header header;
+    bool valid = cache_size >= sizeof(header);
+    if(valid) {
+        memcpy(&header, cache_data, sizeof(header));
+        valid = header.magic == YEP_CACHE_MAGIC && header.version == YEP_CACHE_VERSION &&
+                sizeof(header) + (size_t)header.record_count * sizeof(struct yep_cache_record) <= cache_size;
+    }
+    if(!valid) {
+        yep_logf(yep_log_warning,"Ignoring invalid pack cache %s\n", cache_path);
+        free(cache_data);
+        return cache;
+    }
+    if(header.options_key != options_key) {
+        yep_logf(yep_log_debug,"Pack options changed since %s was written, packing everything\n", cache_path);
+        free(cache_data);
+        return cache;
+    }
+
+    size_t pack_size;
+    const void *pack_data = yep_map_file(pack_path, &pack_size);
+    if(pack_data == NULL || table_hash(pack_data, pack_size) != header.table_hash) {
+        yep_logf(yep_log_debug,"%s does not match its cache, packing everything\n", pack_path);
+        yep_unmap_file(pack_data, pack_size);
+        free(cache_data);
+        return cache;
+    }
+
+    FILE *pack_file = fopen(pack_path, "rb");
+    cache->pack = pack_file != NULL ? yep_pack_open_memory(pack_data, pack_size, pack_path) : NULL;
+    if(cache->pack == NULL) {
+        if(pack_file != NULL)
+            fclose(pack_file);
+        yep_unmap_file(pack_data, pack_size);
+        free(cache_data);
+        return cache;
+    }
+    cache->pack_data = pack_data;
+    cache->pack_size = pack_size;
+    cache->pack_file = pack_file;
+
+    cache->old_count = header.record_count;
+    cache->old_records = malloc((header.record_count ? header.record_count : 1) * sizeof(struct yep_cache_record));
+    memcpy(cache->old_records, cache_data + sizeof(header), (size_t)header.record_count * sizeof(struct yep_cache_record));
+    for(uint32_t i = 0; i < cache->old_count; i++)
+        cache->old_records[i].name[63] = '\0';
+    qsort(cache->old_records, cache->old_count, sizeof(struct yep_cache_record), compare_records);
+
+    free(cache_data);
+    return cache;
+}
+
+bool yep_cache_lookup(struct yep_cache *cache, const struct yep_header_node *node, struct yep_cache_entry *out) {
+    // generated entries depend on more than one file, they are always rebuilt
+    if(node->payload != NULL || node->frames != NULL)
+        return false;
+
+    // the stat is taken before the file is read (by the walk that found it),
+    // an edit while packing just misses next time
+    SDL_PathInfo info;
+    if(!yep_stat_cache_get(cache->stats, node->fullpath, &info))
+        return false;
+
+    if(cache->count == cache->capacity) {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : 256;
+        cache->records = realloc(cache->records, cache->capacity * sizeof(struct yep_cache_record));
+    }
+
+    struct yep_cache_record *record = &cache->records[cache->count++];
+    memset(record, 0, sizeof(*record));
+    memcpy(record->name, node->name, sizeof(record->name));
+    record->modify_time = (int64_t)info.modify_time;
+    record->size = info.size;
+
+    if(cache->pack == NULL)
+        return false;
+
+    const struct yep_cache_record *old = bsearch(record, cache->old_records, cache->old_count, sizeof(struct yep_cache_record), compare_records);
+    if(old == NULL || old->modify_time != record->modify_time || old->size != record->size)
+        return false;
+
+    int32_t index = yep_pack_find(cache->pack, node->name);
+    if(index < 0)
+        return false;
+
+    const struct yep_entry *entry = yep_pack_entry(cache->pack, (uint32_t)index);
+    out->source = cache->pack_file;
+    out->offset = entry->offset;
+    out->size = entry->size;
+    out->uncompressed_size = entry->uncompressed_size;
+    out->compression_type = entry->compression_type;
+    out->data_type = entry->data_type;
+
+    cache->hits++;
+    return true;
+}
+
+uint32_t yep_cache_hits(const struct yep_cache *cache) {
+    return cache->hits;
+}
+
+bool yep_cache_save(const struct yep_cache *cache, const char *cache_path, const char *pack_path) {
+    // only the header table is needed to recognize the pack later
+    size_t pack_size;
+    const uint8_t *pack = yep_map_file(pack_path, &pack_size);
+    if(pack == NULL)
+        return false;
+
+    struct yep_cache_header header = {
+        .magic = YEP_CACHE_MAGIC,
+        .version = YEP_CACHE_VERSION,
+        .options_key = cache->options_key,
+        .table_hash = table_hash(pack, pack_size),
+        .record_count = cache->count,
+        .reserved = 0,
+    };
+    yep_unmap_file(pack, pack_size);
+
+    FILE *file = fopen(cache_path, "wb");
+    if(file == NULL) {
+        yep_logf(yep_log_warning,"Error opening pack cache %s\n", cache_path);
+        return false;
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+    if(cache->count > 0)
+        fwrite(cache->records, sizeof(struct yep_cache_record), cache->count, file);
+
+    if(fclose(file) != 0) {
+        yep_logf(yep_log_warning,"Error writing pack cache %s\n", cache_path);
+        return false;
+    }
+    return true;
+}
+
+void yep_cache_close(struct yep_cache *cache) {
+    if(cache == NULL)
+        return;
+
+    yep_pack_close(cache->pack);
+    yep_unmap_file(cache->pack_data, cache->pack_size);
+    if(cache->pack_file != NULL)
+        fclose(cache->pack_file);
+    free(cache->old_records);
+    free(cache->records);
+    free(cache);
+}
+
+/*
+    =================================== DEPFILE ==================================
+*/
+
+struct yep_depfile {
+    char **paths;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+struct yep_depfile *yep_depfile_create(void) {
+    return calloc(1, sizeof(struct yep_depfile));
+}
+
+void yep_depfile_add(struct yep_depfile *depfile, const char *path) {
+    if(depfile->count == depfile->capacity) {
+        depfile->capacity = depfile->capacity ? depfile->capacity * 2 : 256;
+        depfile->paths = realloc(depfile->paths, depfile->capacity * sizeof(char *));
+    }
+    depfile->paths[depfile->count++] = strdup(path);
+}
+
+// Make syntax, which Ninja reads as well
+static void write_escaped(FILE *file, const char *path) {
+    for(; *path; path++) {
+        if(*path == ' ' || *path == '#')
+            fputc('\\', file);
+        else if(*path == '$')
+            fputc('$', file);
+        fputc(*path, file);
+    }
+}
+
+bool yep_depfile_write(const struct yep_depfile *depfile, const char *depfile_path, const char *target) {
+    FILE *file = fopen(depfile_path, "w");
+    if(file == NULL) {
+        yep_logf(yep_log_error,"Error opening depfile %s\n", depfile_path);
+        return false;
+    }
+
+    write_escaped(file, target);
+    fputc(':', file);
+    for(uint32_t i = 0; i < depfile->count; i++) {
+        fputs(" \\\n  ", file);
+        write_escaped(file, depfile->paths[i]);
+    }
+    fputc('\n', file);
+
+    if(fclose(file) != 0) {
+        yep_logf(yep_log_error,"Error writing depfile %s\n", depfile_path);
+        return false;
+    }
+    return true;
+}
+
+void yep_depfile_free(struct yep_depfile *depfile) {
+    if(depfile == NULL)
+        return;
+
+    for(uint32_t i = 0; i < depfile->count; i++)
+        free(depfile->paths[i]);
+    free(depfile->paths);
+    free(depfile);
+}
@@ -0,0 +1,214 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Client side of `yep serve`, see yep_client_connect()
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <limits.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+#endif
+
+struct yep_client {
+    int fd;
+};
+
+#ifndef _WIN32
+
+struct yep_client *yep_client_connect(const char *socket_path) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if(strlen(socket_path) >= sizeof(address.sun_path)) {
+        yep_logf(yep_log_error, "Socket path %s is too long\n", socket_path);
+        return NULL;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+        return NULL;
+
+    if(connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        yep_logf(yep_log_debug, "No yep server at %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    struct yep_client *client = malloc(sizeof(struct yep_client));
+    client->fd = fd;
+    return client;
+}
+
+static bool send_all(int fd, const void *data, size_t size) {
+    const char *bytes = data;
+    while(size > 0) {
+        ssize_t sent = send(fd, bytes, size, 0);
+        if(sent < 0 && errno == EINTR)
+            continue;
+        if(sent <= 0)
+            return false;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+// reads the response and the descriptor that comes with it (-1 if none)
+static bool receive_response(int fd, struct yep_serve_response *response, int *payload_fd) {
+    *payload_fd = -1;
+
+    char *bytes = (char *)response;
+    size_t have = 0;
+    while(have < sizeof(*response)) {
+        struct iovec iov = { .iov_base = bytes + have, .iov_len = sizeof(*response) - have };
+        union {
+            struct cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(int))];
+        } control;
+        struct msghdr message = {
+            .msg_iov = &iov,
+            .msg_iovlen = 1,
+            .msg_control = control.buffer,
+            .msg_controllen = sizeof(control.buffer),
+        };
+
+        ssize_t received = recvmsg(fd, &message, 0);
+        if(received < 0 && errno == EINTR)
+            continue;
+        if(received <= 0)
+            break;
+        have += (size_t)received;
+
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        if(header != NULL && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+            memcpy(payload_fd, CMSG_DATA(header), sizeof(int));
+    }
+
+    if(have == sizeof(*response))
+        return true;
+
+    if(*payload_fd >= 0)
+        close(*payload_fd);
+    *payload_fd = -1;
+    return false;
+}
+
+bool yep_client_extract(struct yep_client *client, const char *pack, const char *handle, struct yep_served_entry *out) {
+    memset(out, 0, sizeof(*out));
+
+    struct yep_serve_request request;
+    memset(&request, 0, sizeof(request));
+    request.magic = YEP_SERVE_MAGIC;
+    request.version = YEP_SERVE_VERSION;
+
+    // the server has its own working directory
+    char resolved[PATH_MAX];
+    if(realpath(pack, resolved) == NULL) {
+        yep_logf(yep_log_error, "Error resolving pack path %s: %s\n", pack, strerror(errno));
+        return false;
+    }
+    if(strlen(resolved) >= sizeof(request.pack) || strlen(handle) >= sizeof(request.handle)) {
+        yep_logf(yep_log_error, "Pack path or handle too long for %s\n", handle);
+        return false;
+    }
+    strcpy(request.pack, resolved);
+    strcpy(request.handle, handle);
+
+    struct yep_serve_response response;
+    int fd;
+    if(!send_all(client->fd, &request, sizeof(request)) || !receive_response(client->fd, &response, &fd)) {
+        yep_logf(yep_log_error, "Lost the connection to the yep server\n");
+        return false;
+    }
+
+    if(response.status != YEP_SERVE_OK) {
+        if(fd >= 0)
+            close(fd);
+        yep_logf(yep_log_warning, "yep server could not extract %s from %s (status %u)\n", handle, resolved, response.status);
+        return false;
+    }
+
+    out->size = (size_t)response.size;
+    out->data_type = (uint8_t)response.data_type;
+
+    // an empty file cannot be mapped
+    if(response.size == 0) {
+        if(fd >= 0)
+            close(fd);
+        out->data = "";
+        return true;
+    }
+    if(fd < 0) {
+        yep_logf(yep_log_error, "yep server sent %s without its payload\n", handle);
+        return false;
+    }
+
+    // mappings start on a page boundary, entries inside the pack file do not
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = response.offset & ~(page - 1);
+    size_t length = (size_t)(response.offset - start + response.size);
+
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, (off_t)start);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        yep_logf(yep_log_error, "Error mapping %s: %s\n", handle, strerror(errno));
+        return false;
+    }
+
+    out->mapping = mapping;
+    out->mapping_size = length;
+    out->data = (const char *)mapping + (response.offset - start);
+    return true;
+}
+
+void yep_client_release(struct yep_served_entry *entry) {
+    if(entry->mapping != NULL)
+        munmap(entry->mapping, entry->mapping_size);
+    memset(entry, 0, sizeof(*entry));
+}
+
+void yep_client_close(struct yep_client *client) {
+    if(client == NULL)
+        return;
+
+    close(client->fd);
+    free(client);
+}
+
+#else
+
+struct yep_client *yep_client_connect(const char *socket_path) {
+    yep_logf(yep_log_error, "yep serve is not supported on this platform (%s)\n", socket_path);
+    return NULL;
+}
+
+bool yep_client_extract(struct yep_client *client, const char *pack, const char *handle, struct yep_served_entry *out) {
+    (void)client; (void)pack; (void)handle;
+    memset(out, 0, sizeof(*out));
+    return false;
+}
+
+void yep_client_release(struct yep_served_entry *entry) {
+    memset(entry, 0, sizeof(*entry));
+}
+
+void yep_client_close(struct yep_client *client) {
+    free(client);
+}
+
+#endif
@@ -0,0 +1,350 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Predictive filtering for raw pixels (YEP_COMPRESSION_FILTERED_ZLIB)
+
+    Deflate only finds repeated byte strings, so gradients and noise in raw RGBA barely
+    compress. Like PNG, every row of every mip level is first replaced by its difference
+    to a prediction (left, above, average or paeth, picked per row), which turns smooth
+    areas into runs of small values that deflate handles well.
+
+    Stream layout (before deflate):
+        yep_image_header (copied verbatim)
+        one filter byte per row, for all mip levels in order
+        filtered pixels, same size and order as the payload
+
+    Unfiltering happens in place on the output buffer, with SSE2 when it is available.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <zlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define YEP_FILTER_SSE2
+#endif
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define BPP 4   // only RGBA8 payloads are filtered
+
+enum yep_row_filter {
+    YEP_ROW_NONE,
+    YEP_ROW_SUB,
+    YEP_ROW_UP,
+    YEP_ROW_AVERAGE,
+    YEP_ROW_PAETH,
+    YEP_ROW_FILTER_COUNT,
+};
+
+static inline uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if(pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+static uint32_t total_rows(const struct yep_image *image) {
+    uint32_t rows = 0;
+    for(uint8_t level = 0; level < image->mip_count; level++)
+        rows += image->mips[level].height;
+    return rows;
+}
+
+/*
+    ================================== ENCODE ==================================
+*/
+
+// prior is NULL for the first row of a level, which behaves like a row of zeros
+static void filter_row(int filter, const uint8_t *row, const uint8_t *prior, size_t bytes, uint8_t *out) {
+    for(size_t i = 0; i < bytes; i++) {
+        uint8_t left = i >= BPP ? row[i - BPP] : 0;
+        uint8_t up = prior ? prior[i] : 0;
+        uint8_t up_left = prior && i >= BPP ? prior[i - BPP] : 0;
+
+        uint8_t prediction;
+        switch(filter) {
+            case YEP_ROW_SUB:     prediction = left; break;
+            case YEP_ROW_UP:      prediction = up; break;
+            case YEP_ROW_AVERAGE: prediction = (uint8_t)((left + up) / 2); break;
+            case YEP_ROW_PAETH:   prediction = paeth(left, up, up_left); break;
+            default:              prediction = 0; break;
+        }
+        out[i] = (uint8_t)(row[i] - prediction);
+    }
+}
+
+// the usual png heuristic: smallest sum of residuals read as signed bytes
+static uint64_t row_cost(const uint8_t *filtered, size_t bytes) {
+    uint64_t cost = 0;
+    for(size_t i = 0; i < bytes; i++)
+        cost += (uint64_t)abs((int8_t)filtered[i]);
+    return cost;
+}
+
+bool yep_filter_compress(const char *input, size_t input_size, char **output, size_t *output_size) {
+    struct yep_image image;
+    if(!yep_image_parse(input, input_size, &image))
+        return false;
+
+    uint32_t rows = total_rows(&image);
+    size_t stream_size = input_size + rows;
+    uint8_t *stream = malloc(stream_size);
+    memcpy(stream, input, sizeof(struct yep_image_header));
+
+    uint8_t *filters = stream + sizeof(struct yep_image_header);
+    uint8_t *cursor = filters + rows;
+    uint8_t *candidates[YEP_ROW_FILTER_COUNT];
+    size_t widest = (size_t)image.width * BPP;
+    for(int f = 0; f < YEP_ROW_FILTER_COUNT; f++)
+        candidates[f] = malloc(widest);
+
+    uint32_t row_index = 0;
+    for(uint8_t level = 0; level < image.mip_count; level++) {
+        size_t bytes = (size_t)image.mips[level].width * BPP;
+        const uint8_t *pixels = image.mips[level].pixels;
+
+        for(uint32_t y = 0; y < image.mips[level].height; y++, row_index++) {
+            const uint8_t *row = pixels + y * bytes;
+            const uint8_t *prior = y > 0 ? row - bytes : NULL;
+
+            int best = YEP_ROW_NONE;
+            uint64_t best_cost = UINT64_MAX;
+            for(int f = 0; f < YEP_ROW_FILTER_COUNT; f++) {
+                filter_row(f, row, prior, bytes, candidates[f]);
+                uint64_t cost = row_cost(candidates[f], bytes);
+                if(cost < best_cost) {
+                    best = f;
+                    best_cost = cost;
+                }
+            }
+
+            filters[row_index] = (uint8_t)best;
+            memcpy(cursor, candidates[best], bytes);
+            cursor += bytes;
+        }
+    }
+
+    for(int f = 0; f < YEP_ROW_FILTER_COUNT; f++)
+        free(candidates[f]);
+
+    // anything after the last mip level is carried along unfiltered
+    size_t tail = input_size - (size_t)(cursor - filters - rows) - sizeof(struct yep_image_header);
+    memcpy(cursor, input + (input_size - tail), tail);
+
+    int result = compress_data((const char *)stream, stream_size, output, output_size);
+    free(stream);
+    return result == 0;
+}
+
+/*
+    ================================== DECODE ==================================
+*/
+
+static void unfilter_up(uint8_t *row, const uint8_t *prior, size_t bytes) {
+    size_t i = 0;
+#ifdef YEP_FILTER_SSE2
+    for(; i + 16 <= bytes; i += 16) {
+        __m128i current = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i above = _mm_loadu_si128((const __m128i *)(prior + i));
+        _mm_storeu_si128((__m128i *)(row + i), _mm_add_epi8(current, above));
+    }
+#endif
+    for(; i < bytes; i++)
+        row[i] = (uint8_t)(row[i] + prior[i]);
+}
+
+#ifdef YEP_FILTER_SSE2
+/*
+    The left neighbour makes sub, average and paeth serial per pixel, but all four
+    channels of a pixel can be done at once (same approach as libpng's filter_sse2)
+*/
+static inline __m128i load_pixel(const uint8_t *p) {
+    int32_t value;
+    memcpy(&value, p, sizeof(value));
+    return _mm_cvtsi32_si128(value);
+}
+
+static inline void store_pixel(uint8_t *p, __m128i pixel) {
+    int32_t value = _mm_cvtsi128_si32(pixel);
+    memcpy(p, &value, sizeof(value));
+}
+
+static void unfilter_sub(uint8_t *row, size_t bytes) {
+    __m128i left = _mm_setzero_si128();
+    for(size_t i = 0; i < bytes; i += BPP) {
+        left = _mm_add_epi8(left, load_pixel(row + i));
+        store_pixel(row + i, left);
+    }
+}
+
+static void unfilter_average(uint8_t *row, const uint8_t *prior, size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(1);
+    __m128i left = zero;
+    for(size_t i = 0; i < bytes; i += BPP) {
+        __m128i up = prior ? load_pixel(prior + i) : zero;
+
+        // floor((a + b) / 2) = avg_rounding_up(a, b) - ((a ^ b) & 1)
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), ones));
+        left = _mm_add_epi8(average, load_pixel(row + i));
+        store_pixel(row + i, left);
+    }
+}
+
+static inline __m128i abs_epi16(__m128i x) {
+    __m128i negative = _mm_srai_epi16(x, 15);
+    return _mm_sub_epi16(_mm_xor_si128(x, negative), negative);
+}
+
+static void unfilter_paeth(uint8_t *row, const uint8_t *prior, size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;   // left
+    __m128i c = zero;   // above left
+    for(size_t i = 0; i < bytes; i += BPP) {
+        __m128i b = _mm_unpacklo_epi8(load_pixel(prior + i), zero);
+        __m128i x = _mm_unpacklo_epi8(load_pixel(row + i), zero);
+
+        // pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = abs_epi16(_mm_add_epi16(pa, pb));
+        pa = abs_epi16(pa);
+        pb = abs_epi16(pb);
+
+        // pick a unless pb or pc is strictly smaller, then b unless pc is strictly smaller
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+        __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+        __m128i prediction = _mm_or_si128(_mm_and_si128(use_a, a),
+                             _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(_mm_or_si128(use_a, use_b), c)));
+
+        a = _mm_and_si128(_mm_add_epi16(x, prediction), _mm_set1_epi16(0xFF));
+        store_pixel(row + i, _mm_packus_epi16(a, a));
+        c = b;
+    }
+}
+#else
+static void unfilter_sub(uint8_t *row, size_t bytes) {
+    for(size_t i = BPP; i < bytes; i++)
+        row[i] = (uint8_t)(row[i] + row[i - BPP]);
+}
+
+static void unfilter_average(uint8_t *row, const uint8_t *prior, size_t bytes) {
+    for(size_t i = 0; i < bytes; i++) {
+        uint8_t left = i >= BPP ? row[i - BPP] : 0;
+        uint8_t up = prior ? prior[i] : 0;
+        row[i] = (uint8_t)(row[i] + (left + up) / 2);
+    }
+}
+
+static void unfilter_paeth(uint8_t *row, const uint8_t *prior, size_t bytes) {
+    for(size_t i = 0; i < bytes; i++) {
+        uint8_t left = i >= BPP ? row[i - BPP] : 0;
+        uint8_t up_left = i >= BPP ? prior[i - BPP] : 0;
+        row[i] = (uint8_t)(row[i] + paeth(left, prior[i], up_left));
+    }
+}
+#endif
+
+static bool unfilter_row(int filter, uint8_t *row, const uint8_t *prior, size_t bytes) {
+    switch(filter) {
+        case YEP_ROW_NONE:
+            return true;
+        case YEP_ROW_SUB:
+            unfilter_sub(row, bytes);
+            return true;
+        case YEP_ROW_UP:
+            // the row above the first one is zeros, so up is a no-op there
+            if(prior != NULL)
+                unfilter_up(row, prior, bytes);
+            return true;
+        case YEP_ROW_AVERAGE:
+            unfilter_average(row, prior, bytes);
+            return true;
+        case YEP_ROW_PAETH:
+            // with no row above, paeth always predicts the left neighbour
+            if(prior == NULL)
+                unfilter_sub(row, bytes);
+            else
+                unfilter_paeth(row, prior, bytes);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// inflates exactly size bytes, the stream stays open for the next call
+static bool inflate_exact(z_stream *stream, void *out, size_t size) {
+    stream->next_out = out;
+    stream->avail_out = (uInt)size;
+
+    int result = inflate(stream, Z_SYNC_FLUSH);
+    if(result != Z_OK && result != Z_STREAM_END)
+        return false;
+    return stream->avail_out == 0;
+}
+
+int yep_filter_decompress(const char *input, size_t input_size, char **output, size_t output_size) {
+    if(output_size < sizeof(struct yep_image_header))
+        return -1;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(inflateInit(&stream) != Z_OK)
+        return -1;
+
+    stream.next_in = (Bytef *)input;
+    stream.avail_in = (uInt)input_size;
+
+    uint8_t *out = malloc(output_size);
+    uint8_t *filters = NULL;
+    struct yep_image image;
+
+    // header first, it tells us how many filter bytes follow
+    bool ok = inflate_exact(&stream, out, sizeof(struct yep_image_header));
+    ok = ok && yep_image_parse(out, output_size, &image);
+
+    uint32_t rows = ok ? total_rows(&image) : 0;
+    if(ok) {
+        filters = malloc(rows ? rows : 1);
+        ok = inflate_exact(&stream, filters, rows) &&
+             inflate_exact(&stream, out + sizeof(struct yep_image_header), output_size - sizeof(struct yep_image_header));
+    }
+    inflateEnd(&stream);
+
+    // undo the filters in place, each row only needs the already restored row above it
+    uint32_t row_index = 0;
+    for(uint8_t level = 0; ok && level < image.mip_count; level++) {
+        size_t bytes = (size_t)image.mips[level].width * BPP;
+        uint8_t *pixels = (uint8_t *)image.mips[level].pixels;
+
+        for(uint32_t y = 0; ok && y < image.mips[level].height; y++, row_index++) {
+            uint8_t *row = pixels + y * bytes;
+            ok = unfilter_row(filters[row_index], row, y > 0 ? row - bytes : NULL, bytes);
+        }
+    }
+
+    free(filters);
+
+    if(!ok) {
+        yep_logf(yep_log_error, "Error: corrupt filtered image stream\n");
+        free(out);
+        return -1;
+    }
+
+    *output = (char *)out;
+    return 0;
+}
@@ -12,10 +12,16 @@
     TODO: de-duplicate this and make some clean way to use yoyoengine in this
 */
 
+// copy_file_range()
+#ifdef __linux__
+    #define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdbool.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -24,11 +30,24 @@
 #else
     #include <utime.h>
     #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
     #include <unistd.h>
 #endif
 
+#ifndef _WIN32
+    #include <errno.h>
+    #include <dirent.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/ioctl.h>
+    #include <linux/fs.h>
+#endif
+
 #include <SDL3/SDL.h>
 
+#include "yepfs.h"
 #include "libyep.h"
 
 bool yep_mkdir(const char *path) {
@@ -76,28 +95,186 @@ bool yep_copy_file(const char *src, const char *dst) {
     return res;
 }
 
+// copies the contents of one file through yep_copy_range(), so it can share blocks or stay in the kernel
+static bool _copy_file_contents(const char *src, const char *dst) {
+    FILE *in = fopen(src, "rb");
+    if (in == NULL)
+        return false;
+
+    FILE *out = fopen(dst, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+
+    fseek(in, 0L, SEEK_END);
+    long size = ftell(in);
+
+    bool res = size >= 0 && yep_copy_range(out, 0, in, 0, (uint64_t)size);
+    fclose(in);
+    return fclose(out) == 0 && res;
+}
+
+struct copy_item {
+    char *src;
+    char *dst;
+    time_t access_time;
+    time_t modification_time;
+};
+
+struct copy_job {
+    struct copy_item *files;
+    uint32_t file_count;
+    uint32_t file_capacity;
+
+    struct copy_item *dirs;     // parents before children
+    uint32_t dir_count;
+    uint32_t dir_capacity;
+
+    SDL_AtomicInt next;
+    SDL_AtomicInt failures;
+    bool ok;                    // walking the tree succeeded
+};
+
+struct copy_walk {
+    struct copy_job *job;
+    const char *dst;
+};
+
+static void _copy_add(struct copy_item **items, uint32_t *count, uint32_t *capacity, const char *src, const char *dst, const SDL_PathInfo *info) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *items = realloc(*items, *capacity * sizeof(struct copy_item));
+    }
+
+    (*items)[(*count)++] = (struct copy_item){
+        .src = strdup(src),
+        .dst = strdup(dst),
+        .access_time = (time_t)SDL_NS_TO_SECONDS(info->access_time),
+        .modification_time = (time_t)SDL_NS_TO_SECONDS(info->modify_time),
+    };
+}
+
+// creates the destination directories while listing the files, so the workers only copy
 static SDL_EnumerationResult SDLCALL _recurse_copy_callback(void *userdata, const char *dirname, const char *fname) {
-    char src[512];
-    char dst[512];
+    struct copy_walk *walk = userdata;
+    struct copy_job *job = walk->job;
 
-    snprintf(src, sizeof(src), "%s/%s", dirname, fname);
-    snprintf(dst, sizeof(dst), "%s/%s", (const char *)userdata, fname);
+    char src[4096];
+    char dst[4096];
+    snprintf(src, sizeof(src), "%s%s", dirname, fname);
+    snprintf(dst, sizeof(dst), "%s/%s", walk->dst, fname);
 
-    if(SDL_CopyFile(src, dst)) {
-        yep_logf(yep_log_info, "Copied file from %s to %s\n", src, dst);
-    } else {
-        yep_logf(yep_log_error, "Failed to copy file from %s to %s. %s\n", src, dst, SDL_GetError());
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(src, &info)) {
+        yep_logf(yep_log_error, "Failed to stat %s. %s\n", src, SDL_GetError());
+        job->ok = false;
         return SDL_ENUM_FAILURE;
     }
 
+    if (info.type == SDL_PATHTYPE_DIRECTORY) {
+        if (!SDL_CreateDirectory(dst)) {
+            yep_logf(yep_log_error, "Failed to create directory: %s. %s\n", dst, SDL_GetError());
+            job->ok = false;
+            return SDL_ENUM_FAILURE;
+        }
+        _copy_add(&job->dirs, &job->dir_count, &job->dir_capacity, src, dst, &info);
+
+        struct copy_walk child = { .job = job, .dst = dst };
+        if (!SDL_EnumerateDirectory(src, _recurse_copy_callback, &child) || !job->ok) {
+            job->ok = false;
+            return SDL_ENUM_FAILURE;
+        }
+    }
+    else if (info.type == SDL_PATHTYPE_FILE) {
+        _copy_add(&job->files, &job->file_count, &job->file_capacity, src, dst, &info);
+    }
+    else {
+        yep_logf(yep_log_warning, "Skipping %s, it is neither a file nor a directory\n", src);
+    }
+
     return SDL_ENUM_CONTINUE;
 }
 
+static int SDLCALL _recurse_copy_worker(void *userdata) {
+    struct copy_job *job = userdata;
+
+    for (;;) {
+        uint32_t index = (uint32_t)SDL_AddAtomicInt(&job->next, 1);
+        if (index >= job->file_count)
+            break;
+
+        const struct copy_item *file = &job->files[index];
+        if (!_copy_file_contents(file->src, file->dst)) {
+            yep_logf(yep_log_error, "Failed to copy file from %s to %s\n", file->src, file->dst);
+            SDL_AddAtomicInt(&job->failures, 1);
+            continue;
+        }
+
+        yep_set_fs_times(file->dst, file->access_time, file->modification_time);
+        yep_logf(yep_log_debug, "Copied file from %s to %s\n", file->src, file->dst);
+    }
+
+    return 0;
+}
+
 bool yep_recurse_copy_dir(const char *src, const char *dst) {
-    bool res = SDL_EnumerateDirectory(src, _recurse_copy_callback, NULL);
+    struct copy_job job = { .ok = true };
+    SDL_SetAtomicInt(&job.next, 0);
+    SDL_SetAtomicInt(&job.failures, 0);
+
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(src, &info) || info.type != SDL_PATHTYPE_DIRECTORY || !SDL_CreateDirectory(dst)) {
+        yep_logf(yep_log_error, "Failed to recursively copy directory from %s to %s. %s\n", src, dst, SDL_GetError());
+        return false;
+    }
+
+    struct copy_walk walk = { .job = &job, .dst = dst };
+    if (!SDL_EnumerateDirectory(src, _recurse_copy_callback, &walk))
+        job.ok = false;
 
-    if(res) yep_logf(yep_log_info, "Recursively copied directory from %s to %s\n", src, dst);
-    else    yep_logf(yep_log_error, "Failed to recursively copy directory from %s to %s. %s\n", src, dst, SDL_GetError());
+    // files are independent, so they are copied in parallel (one stays in flight per core)
+    if (job.ok) {
+        int workers = SDL_GetNumLogicalCPUCores();
+        if (workers > (int)job.file_count)
+            workers = (int)job.file_count;
+
+        if (workers <= 1) {
+            _recurse_copy_worker(&job);
+        } else {
+            SDL_Thread **threads = calloc((size_t)workers, sizeof(SDL_Thread *));
+            for (int i = 0; i < workers; i++)
+                threads[i] = SDL_CreateThread(_recurse_copy_worker, "yep_copy", &job);
+            for (int i = 0; i < workers; i++) {
+                if (threads[i] == NULL)
+                    _recurse_copy_worker(&job);
+                else
+                    SDL_WaitThread(threads[i], NULL);
+            }
+            free(threads);
+        }
+
+        // creating entries touched every directory, children get their times back before their parents
+        for (uint32_t i = job.dir_count; i-- > 0;)
+            yep_set_fs_times(job.dirs[i].dst, job.dirs[i].access_time, job.dirs[i].modification_time);
+        yep_set_fs_times(dst, (time_t)SDL_NS_TO_SECONDS(info.access_time), (time_t)SDL_NS_TO_SECONDS(info.modify_time));
+    }
+
+    bool res = job.ok && SDL_GetAtomicInt(&job.failures) == 0;
+
+    if(res) yep_logf(yep_log_info, "Recursively copied directory from %s to %s (%u files)\n", src, dst, job.file_count);
+    else    yep_logf(yep_log_error, "Failed to recursively copy directory from %s to %s\n", src, dst);
+
+    for (uint32_t i = 0; i < job.file_count; i++) {
+        free(job.files[i].src);
+        free(job.files[i].dst);
+    }
+    for (uint32_t i = 0; i < job.dir_count; i++) {
+        free(job.dirs[i].src);
+        free(job.dirs[i].dst);
+    }
+    free(job.files);
+    free(job.dirs);
 
     return res;
 }
@@ -170,6 +347,376 @@ bool yep_get_path_info(const char *path, SDL_PathInfo *info) {
     }
 }
 
+/*
+    Stat cache, see yep_stat_cache_walk()
+
+    Records live in one array, found by path through an open addressed table. A swept
+    directory owns the contiguous run of records for its children, so a walk can be
+    replayed from the cache without listing or statting anything again.
+*/
+
+struct yep_stat_record {
+    char *path;
+    SDL_PathInfo info;
+    bool swept;                 // the children are in the cache
+    uint32_t first_child;
+    uint32_t child_count;
+};
+
+struct yep_stat_cache {
+    struct yep_stat_record *records;
+    uint32_t count;
+    uint32_t capacity;
+
+    uint32_t *buckets;          // record index + 1, 0 is empty
+    uint32_t bucket_count;
+};
+
+// what one sweep of a directory found, filled by a worker and merged afterwards
+struct stat_sweep {
+    uint32_t dir;
+    char **paths;
+    SDL_PathInfo *infos;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+struct stat_sweep_job {
+    struct stat_sweep *sweeps;
+    uint32_t count;
+    SDL_AtomicInt next;
+};
+
+static uint64_t _stat_hash(const char *path) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static int64_t _stat_find(const struct yep_stat_cache *cache, const char *path) {
+    if (cache->bucket_count == 0)
+        return -1;
+
+    uint32_t mask = cache->bucket_count - 1;
+    for (uint32_t slot = (uint32_t)_stat_hash(path) & mask;; slot = (slot + 1) & mask) {
+        uint32_t index = cache->buckets[slot];
+        if (index == 0)
+            return -1;
+        if (strcmp(cache->records[index - 1].path, path) == 0)
+            return index - 1;
+    }
+}
+
+static void _stat_index(struct yep_stat_cache *cache, uint32_t index) {
+    uint32_t mask = cache->bucket_count - 1;
+    const char *path = cache->records[index].path;
+    for (uint32_t slot = (uint32_t)_stat_hash(path) & mask;; slot = (slot + 1) & mask) {
+        uint32_t existing = cache->buckets[slot];
+        // a path swept again (after a plain lookup of it) points at its newest record
+        if (existing == 0 || strcmp(cache->records[existing - 1].path, path) == 0) {
+            cache->buckets[slot] = index + 1;
+            return;
+        }
+    }
+}
+
+// takes ownership of path
+static uint32_t _stat_add(struct yep_stat_cache *cache, char *path, const SDL_PathInfo *info) {
+    if (cache->count == cache->capacity) {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : 256;
+        cache->records = realloc(cache->records, cache->capacity * sizeof(struct yep_stat_record));
+    }
+
+    uint32_t index = cache->count++;
+    cache->records[index] = (struct yep_stat_record){ .path = path, .info = *info };
+
+    // kept under half full
+    if (cache->count * 2 > cache->bucket_count) {
+        cache->bucket_count = cache->bucket_count ? cache->bucket_count * 2 : 512;
+        free(cache->buckets);
+        cache->buckets = calloc(cache->bucket_count, sizeof(uint32_t));
+        for (uint32_t i = 0; i < cache->count; i++)
+            _stat_index(cache, i);
+    } else {
+        _stat_index(cache, index);
+    }
+    return index;
+}
+
+static void _stat_sweep_add(struct stat_sweep *sweep, const char *dir, const char *name, const SDL_PathInfo *info) {
+    if (sweep->count == sweep->capacity) {
+        sweep->capacity = sweep->capacity ? sweep->capacity * 2 : 32;
+        sweep->paths = realloc(sweep->paths, sweep->capacity * sizeof(char *));
+        sweep->infos = realloc(sweep->infos, sweep->capacity * sizeof(SDL_PathInfo));
+    }
+
+    size_t dir_length = strlen(dir);
+    bool separator = dir_length > 0 && (dir[dir_length - 1] == '/' || dir[dir_length - 1] == '\\');
+
+    char *path = malloc(dir_length + strlen(name) + 2);
+    sprintf(path, separator ? "%s%s" : "%s/%s", dir, name);
+
+    sweep->paths[sweep->count] = path;
+    sweep->infos[sweep->count] = *info;
+    sweep->count++;
+}
+
+#ifdef _WIN32
+
+static SDL_EnumerationResult SDLCALL _stat_sweep_callback(void *userdata, const char *dirname, const char *fname) {
+    struct stat_sweep *sweep = userdata;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%s", dirname, fname);
+
+    SDL_PathInfo info;
+    if (SDL_GetPathInfo(path, &info))
+        _stat_sweep_add(sweep, dirname, fname, &info);
+    return SDL_ENUM_CONTINUE;
+}
+
+static void _stat_sweep_dir(struct stat_sweep *sweep, const char *dir) {
+    if (!SDL_EnumerateDirectory(dir, _stat_sweep_callback, sweep))
+        yep_logf(yep_log_error, "Failed to list directory: %s. %s\n", dir, SDL_GetError());
+}
+
+#else
+
+// same fields SDL_GetPathInfo() fills, so records compare equal to ones it produced
+static void _stat_fill_info(mode_t mode, uint64_t size, SDL_Time create_time, SDL_Time modify_time, SDL_Time access_time, SDL_PathInfo *info) {
+    if (S_ISREG(mode))      info->type = SDL_PATHTYPE_FILE;
+    else if (S_ISDIR(mode)) info->type = SDL_PATHTYPE_DIRECTORY;
+    else                    info->type = SDL_PATHTYPE_OTHER;
+
+    info->size = S_ISDIR(mode) ? 0 : size;
+    info->create_time = create_time;
+    info->modify_time = modify_time;
+    info->access_time = access_time;
+}
+
+// follows symbolic links like SDL_GetPathInfo()
+static bool _stat_at(int dir_fd, const char *name, SDL_PathInfo *info) {
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+    struct statx stx;
+    if (statx(dir_fd, name, AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE | STATX_CTIME | STATX_MTIME | STATX_ATIME, &stx) == 0) {
+        _stat_fill_info(stx.stx_mode, stx.stx_size,
+                        (SDL_Time)SDL_SECONDS_TO_NS(stx.stx_ctime.tv_sec) + stx.stx_ctime.tv_nsec,
+                        (SDL_Time)SDL_SECONDS_TO_NS(stx.stx_mtime.tv_sec) + stx.stx_mtime.tv_nsec,
+                        (SDL_Time)SDL_SECONDS_TO_NS(stx.stx_atime.tv_sec) + stx.stx_atime.tv_nsec, info);
+        return true;
+    }
+    // kernels before 4.11 do not have it
+    if (errno != ENOSYS)
+        return false;
+#endif
+
+    struct stat st;
+    if (fstatat(dir_fd, name, &st, 0) != 0)
+        return false;
+
+#if defined(__APPLE__)
+    _stat_fill_info(st.st_mode, (uint64_t)st.st_size,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_ctimespec.tv_sec) + st.st_ctimespec.tv_nsec,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_mtimespec.tv_sec) + st.st_mtimespec.tv_nsec,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_atimespec.tv_sec) + st.st_atimespec.tv_nsec, info);
+#else
+    _stat_fill_info(st.st_mode, (uint64_t)st.st_size,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_ctim.tv_sec) + st.st_ctim.tv_nsec,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_mtim.tv_sec) + st.st_mtim.tv_nsec,
+                    (SDL_Time)SDL_SECONDS_TO_NS(st.st_atim.tv_sec) + st.st_atim.tv_nsec, info);
+#endif
+    return true;
+}
+
+// every entry is statted relative to the open directory, so the kernel never walks the full path again
+static void _stat_sweep_dir(struct stat_sweep *sweep, const char *dir) {
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR *listing = fd >= 0 ? fdopendir(fd) : NULL;
+    if (listing == NULL) {
+        if (fd >= 0)
+            close(fd);
+        yep_logf(yep_log_error, "Failed to open directory: %s. %s\n", dir, strerror(errno));
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(listing)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        SDL_PathInfo info;
+        if (_stat_at(fd, entry->d_name, &info))
+            _stat_sweep_add(sweep, dir, entry->d_name, &info);
+        else
+            yep_logf(yep_log_error, "Failed to retrieve file info for: %s/%s. %s\n", dir, entry->d_name, strerror(errno));
+    }
+
+    closedir(listing);
+}
+
+#endif
+
+struct stat_sweep_worker {
+    struct stat_sweep_job *job;
+    const struct yep_stat_cache *cache;
+};
+
+static int SDLCALL _stat_sweep_worker(void *userdata) {
+    struct stat_sweep_worker *worker = userdata;
+    struct stat_sweep_job *job = worker->job;
+
+    for (;;) {
+        uint32_t index = (uint32_t)SDL_AddAtomicInt(&job->next, 1);
+        if (index >= job->count)
+            break;
+
+        struct stat_sweep *sweep = &job->sweeps[index];
+        _stat_sweep_dir(sweep, worker->cache->records[sweep->dir].path);
+    }
+
+    return 0;
+}
+
+/*
+    Sweeps the tree under the directory record root one level at a time, the directories
+    of a level are listed and statted in parallel and merged in order afterwards
+*/
+static void _stat_sweep_tree(struct yep_stat_cache *cache, uint32_t root) {
+    int cores = SDL_GetNumLogicalCPUCores();
+
+    uint32_t *level = malloc(sizeof(uint32_t));
+    uint32_t level_count = 1;
+    level[0] = root;
+
+    while (level_count > 0) {
+        struct stat_sweep_job job = {
+            .sweeps = calloc(level_count, sizeof(struct stat_sweep)),
+            .count = level_count,
+        };
+        SDL_SetAtomicInt(&job.next, 0);
+        for (uint32_t i = 0; i < level_count; i++)
+            job.sweeps[i].dir = level[i];
+
+        struct stat_sweep_worker worker = { .job = &job, .cache = cache };
+
+        int workers = cores < (int)level_count ? cores : (int)level_count;
+        if (workers <= 1) {
+            _stat_sweep_worker(&worker);
+        } else {
+            SDL_Thread **threads = calloc((size_t)workers, sizeof(SDL_Thread *));
+            for (int i = 0; i < workers; i++)
+                threads[i] = SDL_CreateThread(_stat_sweep_worker, "yep_stat", &worker);
+            for (int i = 0; i < workers; i++) {
+                if (threads[i] == NULL)
+                    _stat_sweep_worker(&worker);
+                else
+                    SDL_WaitThread(threads[i], NULL);
+            }
+            free(threads);
+        }
+
+        uint32_t next_count = 0;
+        for (uint32_t i = 0; i < level_count; i++)
+            next_count += job.sweeps[i].count;
+        uint32_t *next = malloc((next_count ? next_count : 1) * sizeof(uint32_t));
+        next_count = 0;
+
+        for (uint32_t i = 0; i < level_count; i++) {
+            struct stat_sweep *sweep = &job.sweeps[i];
+
+            uint32_t first = cache->count;
+            for (uint32_t j = 0; j < sweep->count; j++) {
+                uint32_t child = _stat_add(cache, sweep->paths[j], &sweep->infos[j]);
+                if (sweep->infos[j].type == SDL_PATHTYPE_DIRECTORY)
+                    next[next_count++] = child;
+            }
+
+            struct yep_stat_record *dir = &cache->records[sweep->dir];
+            dir->swept = true;
+            dir->first_child = first;
+            dir->child_count = sweep->count;
+
+            free(sweep->paths);
+            free(sweep->infos);
+        }
+
+        free(job.sweeps);
+        free(level);
+        level = next;
+        level_count = next_count;
+    }
+
+    free(level);
+}
+
+static void _stat_replay(const struct yep_stat_cache *cache, uint32_t dir, yep_stat_callback callback, void *userdata) {
+    const struct yep_stat_record *record = &cache->records[dir];
+    for (uint32_t i = 0; i < record->child_count; i++) {
+        uint32_t child = record->first_child + i;
+        callback(cache->records[child].path, &cache->records[child].info, userdata);
+        if (cache->records[child].swept)
+            _stat_replay(cache, child, callback, userdata);
+    }
+}
+
+struct yep_stat_cache *yep_stat_cache_create(void) {
+    return calloc(1, sizeof(struct yep_stat_cache));
+}
+
+// the index of the record for path, statting it first if it is not cached yet
+static int64_t _stat_lookup(struct yep_stat_cache *cache, const char *path) {
+    int64_t index = _stat_find(cache, path);
+    if (index >= 0)
+        return index;
+
+    SDL_PathInfo info;
+    if (!yep_get_path_info(path, &info))
+        return -1;
+    return _stat_add(cache, strdup(path), &info);
+}
+
+bool yep_stat_cache_get(struct yep_stat_cache *cache, const char *path, SDL_PathInfo *info) {
+    int64_t index = _stat_lookup(cache, path);
+    if (index < 0)
+        return false;
+
+    *info = cache->records[index].info;
+    return true;
+}
+
+bool yep_stat_cache_walk(struct yep_stat_cache *cache, const char *root, yep_stat_callback callback, void *userdata) {
+    int64_t index = _stat_lookup(cache, root);
+    if (index < 0)
+        return false;
+    if (cache->records[index].info.type != SDL_PATHTYPE_DIRECTORY) {
+        yep_logf(yep_log_error, "Path %s is not a directory\n", root);
+        return false;
+    }
+
+    if (!cache->records[index].swept) {
+        _stat_sweep_tree(cache, (uint32_t)index);
+        yep_logf(yep_log_debug, "Statted %s (%u paths cached)\n", root, cache->count);
+    }
+
+    if (callback != NULL)
+        _stat_replay(cache, (uint32_t)index, callback, userdata);
+    return true;
+}
+
+void yep_stat_cache_free(struct yep_stat_cache *cache) {
+    if (cache == NULL)
+        return;
+
+    for (uint32_t i = 0; i < cache->count; i++)
+        free(cache->records[i].path);
+    free(cache->records);
+    free(cache->buckets);
+    free(cache);
+}
+
 #ifdef _WIN32
     #include <direct.h>
 #else
@@ -196,65 +743,356 @@ bool yep_chdir(const char *path) {
     #endif
 }
 
-// forward decl
-static SDL_EnumerationResult SDLCALL _recurse_delete_callback(void *userdata, const char *dirname, const char *fname);
+#ifdef _WIN32
+
+static SDL_EnumerationResult SDLCALL _recurse_delete_callback(void *userdata, const char *dirname, const char *fname) {
+    bool *ok = userdata;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%s", dirname, fname);
+
+    // one stat per path, removing it reports anything that vanished in between
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path, &info))
+        return SDL_ENUM_CONTINUE;
+
+    if (info.type == SDL_PATHTYPE_DIRECTORY)
+        SDL_EnumerateDirectory(path, _recurse_delete_callback, ok);
+
+    if (!SDL_RemovePath(path)) {
+        yep_logf(yep_log_error, "Failed to delete path: %s. %s\n", path, SDL_GetError());
+        *ok = false;
+    }
+    return SDL_ENUM_CONTINUE;
+}
 
 bool yep_recurse_delete_dir(const char *path) {
-    bool res = SDL_EnumerateDirectory(path, _recurse_delete_callback, NULL);
+    bool ok = true;
+    if (!SDL_EnumerateDirectory(path, _recurse_delete_callback, &ok) || !SDL_RemovePath(path))
+        ok = false;
 
-    if (res) {
-        if (SDL_RemovePath(path)) {
-            yep_logf(yep_log_info, "Recursively deleted directory: %s\n", path);
-        } else {
-            yep_logf(yep_log_error, "Failed to delete directory: %s. %s\n", path, SDL_GetError());
-            return false;
-        }
-    } else {
-        yep_logf(yep_log_error, "Failed to recursively delete directory: %s. %s\n", path, SDL_GetError());
-        return false;
+    if(ok) yep_logf(yep_log_info, "Recursively deleted directory: %s\n", path);
+    else   yep_logf(yep_log_error, "Failed to recursively delete directory: %s. %s\n", path, SDL_GetError());
+
+    return ok;
+}
+
+#else
+
+// stop fanning out once there are this many subtrees per worker
+#define DELETE_SUBTREES_PER_WORKER 4
+#define DELETE_MAX_FANOUT_DEPTH 8
+
+struct delete_list {
+    char **paths;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+struct delete_job {
+    struct delete_list subtrees;
+    SDL_AtomicInt next;
+    SDL_AtomicInt failures;
+};
+
+static void _delete_list_add(struct delete_list *list, char *path) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->paths = realloc(list->paths, list->capacity * sizeof(char *));
     }
+    list->paths[list->count++] = path;
+}
 
-    return true;
+// the entry type comes with the directory listing on most file systems, only stat when it does not
+static bool _is_directory_at(int dir_fd, const struct dirent *entry) {
+#ifdef _DIRENT_HAVE_D_TYPE
+    if (entry->d_type != DT_UNKNOWN)
+        return entry->d_type == DT_DIR;
+#endif
+    struct stat st;
+    return fstatat(dir_fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
 }
 
-static SDL_EnumerationResult SDLCALL _recurse_delete_callback(void *userdata, const char *dirname, const char *fname) {
-    (void)userdata; // unused
-    
-    char path[2038];
-    snprintf(path, sizeof(path), "%s/%s", dirname, fname);
+/*
+    Empties the directory name inside dir_fd. Subdirectories are removed recursively, or
+    added to subdirs when it is given so the caller can hand them to other workers.
 
-    SDL_PathInfo path_info;
-    if (!yep_get_path_info(path, &path_info)) {
-        yep_logf(yep_log_error, "Failed to get path info for: %s. %s\n", path, SDL_GetError());
-        return SDL_ENUM_FAILURE;
+    Returns the number of entries that could not be removed
+*/
+static int _delete_contents_at(int dir_fd, const char *name, const char *path, struct delete_list *subdirs) {
+    int fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    DIR *dir = fd >= 0 ? fdopendir(fd) : NULL;
+    if (dir == NULL) {
+        if (fd >= 0)
+            close(fd);
+        yep_logf(yep_log_error, "Failed to open directory: %s. %s\n", path, strerror(errno));
+        return 1;
     }
 
-    if(path_info.type == SDL_PATHTYPE_DIRECTORY) {
-        // if its a directory: recurse into it
-        if (!yep_recurse_delete_dir(path)) {
-            yep_logf(yep_log_error, "Failed to delete directory: %s. %s\n", path, SDL_GetError());
-            return SDL_ENUM_FAILURE;
+    int failures = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        if (!_is_directory_at(fd, entry)) {
+            if (unlinkat(fd, entry->d_name, 0) != 0 && errno != ENOENT) {
+                yep_logf(yep_log_error, "Failed to delete file: %s/%s. %s\n", path, entry->d_name, strerror(errno));
+                failures++;
+            }
+            continue;
+        }
+
+        char child[4096];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+
+        if (subdirs != NULL) {
+            _delete_list_add(subdirs, strdup(child));
+            continue;
+        }
+
+        failures += _delete_contents_at(fd, entry->d_name, child, NULL);
+        if (unlinkat(fd, entry->d_name, AT_REMOVEDIR) != 0 && errno != ENOENT) {
+            yep_logf(yep_log_error, "Failed to delete directory: %s. %s\n", child, strerror(errno));
+            failures++;
         }
     }
-    else if (path_info.type != SDL_PATHTYPE_FILE) {
-        yep_logf(yep_log_debug, "Skipping non-file path: %s\n", path);
-        return SDL_ENUM_CONTINUE;
+
+    closedir(dir);
+    return failures;
+}
+
+static int SDLCALL _recurse_delete_worker(void *userdata) {
+    struct delete_job *job = userdata;
+
+    for (;;) {
+        uint32_t index = (uint32_t)SDL_AddAtomicInt(&job->next, 1);
+        if (index >= job->subtrees.count)
+            break;
+
+        const char *path = job->subtrees.paths[index];
+        int failures = _delete_contents_at(AT_FDCWD, path, path, NULL);
+        if (rmdir(path) != 0 && errno != ENOENT) {
+            yep_logf(yep_log_error, "Failed to delete directory: %s. %s\n", path, strerror(errno));
+            failures++;
+        }
+
+        if (failures > 0)
+            SDL_AddAtomicInt(&job->failures, failures);
     }
 
-    if (!yep_file_exists(path)) {
-        yep_logf(yep_log_debug, "File does not exist, skipping deletion: %s\n", path);
-        return SDL_ENUM_CONTINUE;
+    return 0;
+}
+
+bool yep_recurse_delete_dir(const char *path) {
+    struct delete_job job = {0};
+    SDL_SetAtomicInt(&job.next, 0);
+    SDL_SetAtomicInt(&job.failures, 0);
+
+    int workers = SDL_GetNumLogicalCPUCores();
+    if (workers < 1)
+        workers = 1;
+
+    // fan out breadth first until there are enough independent subtrees to keep every worker busy,
+    // the directories expanded on the way are removed last, deepest first
+    struct delete_list expanded = {0};
+    struct delete_list frontier = {0};
+    _delete_list_add(&frontier, strdup(path));
+
+    int failures = 0;
+    for (int depth = 0; depth < DELETE_MAX_FANOUT_DEPTH && frontier.count > 0 &&
+                        frontier.count < (uint32_t)workers * DELETE_SUBTREES_PER_WORKER; depth++) {
+        struct delete_list next = {0};
+        for (uint32_t i = 0; i < frontier.count; i++) {
+            failures += _delete_contents_at(AT_FDCWD, frontier.paths[i], frontier.paths[i], &next);
+            _delete_list_add(&expanded, frontier.paths[i]);
+        }
+        free(frontier.paths);
+        frontier = next;
     }
-    if (path_info.type == SDL_PATHTYPE_FILE) {
-        if (SDL_RemovePath(path)) {
-            yep_logf(yep_log_debug, "Deleted file: %s\n", path);
+
+    job.subtrees = frontier;
+    if (workers > (int)job.subtrees.count)
+        workers = (int)job.subtrees.count;
+
+    if (workers <= 1) {
+        _recurse_delete_worker(&job);
+    } else {
+        SDL_Thread **threads = calloc((size_t)workers, sizeof(SDL_Thread *));
+        for (int i = 0; i < workers; i++)
+            threads[i] = SDL_CreateThread(_recurse_delete_worker, "yep_delete", &job);
+        for (int i = 0; i < workers; i++) {
+            if (threads[i] == NULL)
+                _recurse_delete_worker(&job);
+            else
+                SDL_WaitThread(threads[i], NULL);
         }
-        else {
-            yep_logf(yep_log_error, "Failed to delete file: %s. %s\n", path, SDL_GetError());
-            return SDL_ENUM_FAILURE;
+        free(threads);
+    }
+    failures += SDL_GetAtomicInt(&job.failures);
+
+    for (uint32_t i = expanded.count; i-- > 0;) {
+        if (rmdir(expanded.paths[i]) != 0 && errno != ENOENT) {
+            yep_logf(yep_log_error, "Failed to delete directory: %s. %s\n", expanded.paths[i], strerror(errno));
+            failures++;
         }
-        return SDL_ENUM_CONTINUE;
+        free(expanded.paths[i]);
     }
+    for (uint32_t i = 0; i < job.subtrees.count; i++)
+        free(job.subtrees.paths[i]);
+    free(expanded.paths);
+    free(job.subtrees.paths);
 
-    return SDL_ENUM_CONTINUE;
+    if(failures == 0) yep_logf(yep_log_info, "Recursively deleted directory: %s\n", path);
+    else              yep_logf(yep_log_error, "Failed to recursively delete directory: %s (%d failures)\n", path, failures);
+
+    return failures == 0;
+}
+
+#endif
+
+const void *yep_map_file(const char *path, size_t *size) {
+    *size = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        yep_logf(yep_log_error, "Failed to open file for mapping: %s\n", path);
+        return NULL;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        yep_logf(yep_log_error, "Failed to get size of (or empty) file: %s\n", path);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        yep_logf(yep_log_error, "Failed to create file mapping for: %s\n", path);
+        return NULL;
+    }
+
+    // the view keeps the mapping alive
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (base == NULL) {
+        yep_logf(yep_log_error, "Failed to map view of file: %s\n", path);
+        return NULL;
+    }
+
+    *size = (size_t)file_size.QuadPart;
+    return base;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        yep_logf(yep_log_error, "Failed to open file for mapping: %s\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        yep_logf(yep_log_error, "Failed to get size of (or empty) file: %s\n", path);
+        return NULL;
+    }
+
+    // the mapping keeps the file alive
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        yep_logf(yep_log_error, "Failed to map file: %s\n", path);
+        return NULL;
+    }
+
+    *size = (size_t)st.st_size;
+    return base;
+#endif
+}
+
+void yep_unmap_file(const void *base, size_t size) {
+    if (base == NULL)
+        return;
+
+#ifdef _WIN32
+    (void)size; // unused
+    UnmapViewOfFile(base);
+#else
+    munmap((void *)base, size);
+#endif
+}
+
+bool yep_drop_file_cache(const char *path) {
+#if defined(__linux__)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    bool res = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return res;
+#else
+    (void)path; // unsupported
+    return false;
+#endif
+}
+
+bool yep_copy_range(FILE *dst, uint64_t dst_offset, FILE *src, uint64_t src_offset, uint64_t size) {
+#if defined(__linux__)
+    // both calls below bypass stdio, anything still buffered has to reach the file first
+    if (fflush(dst) != 0)
+        return false;
+
+    int dst_fd = fileno(dst);
+    int src_fd = fileno(src);
+
+    // whole blocks can be shared instead of copied, only the end of the source may be a partial block
+    struct stat st;
+    if (fstat(src_fd, &st) == 0 && st.st_blksize > 0 && size > 0 &&
+        src_offset % (uint64_t)st.st_blksize == 0 && dst_offset % (uint64_t)st.st_blksize == 0 &&
+        (size % (uint64_t)st.st_blksize == 0 || src_offset + size == (uint64_t)st.st_size)) {
+        struct file_clone_range range = {
+            .src_fd = src_fd,
+            .src_offset = src_offset,
+            .src_length = size,
+            .dest_offset = dst_offset,
+        };
+        if (ioctl(dst_fd, FICLONERANGE, &range) == 0)
+            return true;
+    }
+
+    loff_t src_position = (loff_t)src_offset;
+    loff_t dst_position = (loff_t)dst_offset;
+    while (size > 0) {
+        ssize_t copied = copy_file_range(src_fd, &src_position, dst_fd, &dst_position, (size_t)size, 0);
+        if (copied < 0 && errno == EINTR)
+            continue;
+        // not supported here (old kernel, some file systems), the rest goes through the buffer
+        if (copied <= 0)
+            break;
+        size -= (uint64_t)copied;
+    }
+    if (size == 0)
+        return true;
+
+    src_offset = (uint64_t)src_position;
+    dst_offset = (uint64_t)dst_position;
+#endif
+
+    const size_t chunk_size = 1 << 20;
+    char *chunk = malloc(chunk_size);
+    bool ok = fseek(src, (long)src_offset, SEEK_SET) == 0 && fseek(dst, (long)dst_offset, SEEK_SET) == 0;
+
+    while (ok && size > 0) {
+        size_t length = size < chunk_size ? (size_t)size : chunk_size;
+        ok = fread(chunk, 1, length, src) == length && fwrite(chunk, 1, length, dst) == length;
+        size -= length;
+    }
+
+    free(chunk);
+    if (!ok)
+        yep_logf(yep_log_error, "Failed to copy a range between files\n");
+    return ok;
 }
@@ -0,0 +1,159 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Generated C header of entry ids, written when yep_pack_options.header_path is set.
+
+    For a pack named resources.yep every entry gets
+
+        #define RESOURCES_SPRITES_WALK_PNG_ID    12u
+        #define RESOURCES_SPRITES_WALK_PNG_HASH  0x...ull
+        #define RESOURCES_SPRITES_WALK_PNG_SIZE  4096u
+        #define RESOURCES_SPRITES_WALK_PNG_TYPE  YEP_DATATYPE_IMAGE
+
+    plus RESOURCES_ENTRY_COUNT and RESOURCES_FINGERPRINT, which matches
+    yep_pack_fingerprint() of the pack the header was generated from.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+static const char *datatype_macro(uint8_t data_type) {
+    switch(data_type) {
+        case YEP_DATATYPE_MISC:          return "YEP_DATATYPE_MISC";
+        case YEP_DATATYPE_IMAGE:         return "YEP_DATATYPE_IMAGE";
+        case YEP_DATATYPE_PCM:           return "YEP_DATATYPE_PCM";
+        case YEP_DATATYPE_LUA_BYTECODE:  return "YEP_DATATYPE_LUA_BYTECODE";
+        case YEP_DATATYPE_ANIMATION:     return "YEP_DATATYPE_ANIMATION";
+        case YEP_DATATYPE_ATLAS:         return "YEP_DATATYPE_ATLAS";
+        default:                         return NULL;
+    }
+}
+
+// uppercases and replaces everything that cannot be in an identifier with '_'
+static void identifier(const char *text, char *out, size_t out_size) {
+    size_t i = 0;
+    for(; *text && i + 1 < out_size; text++)
+        out[i++] = isalnum((unsigned char)*text) ? (char)toupper((unsigned char)*text) : '_';
+    out[i] = '\0';
+}
+
+// "build/resources.yep" -> "RESOURCES"
+static void pack_prefix(const char *pack_path, char *out, size_t out_size) {
+    const char *base = strrchr(pack_path, '/');
+#ifdef _WIN32
+    const char *backslash = strrchr(pack_path, '\\');
+    if(backslash != NULL && (base == NULL || backslash > base))
+        base = backslash;
+#endif
+    base = base ? base + 1 : pack_path;
+
+    char stem[64];
+    snprintf(stem, sizeof(stem), "%s", base);
+    char *dot = strrchr(stem, '.');
+    if(dot != NULL && dot != stem)
+        *dot = '\0';
+
+    identifier(stem, out, out_size);
+
+    // identifiers cannot start with a digit
+    if(!isalpha((unsigned char)out[0]) && out[0] != '_') {
+        char prefixed[72];
+        snprintf(prefixed, sizeof(prefixed), "PACK_%.64s", out);
+        snprintf(out, out_size, "%s", prefixed);
+    }
+}
+
+static char (*sort_identifiers)[160];
+
+static int compare_identifiers(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    int order = strcmp(sort_identifiers[x], sort_identifiers[y]);
+    if(order == 0)
+        order = x < y ? -1 : 1;
+    return order;
+}
+
+bool yep_write_id_header(const char *pack_file, const char *header_file) {
+    struct yep_pack *pack = yep_pack_open(pack_file);
+    if(pack == NULL)
+        return false;
+
+    FILE *file = fopen(header_file, "w");
+    if(file == NULL) {
+        yep_logf(yep_log_error, "Error opening header file %s\n", header_file);
+        yep_pack_close(pack);
+        return false;
+    }
+
+    char prefix[72];
+    pack_prefix(pack_file, prefix, sizeof(prefix));
+    uint32_t count = yep_pack_entry_count(pack);
+
+    fprintf(file, "/*\n    Generated by yep from %s, do not edit.\n\n", pack_file);
+    fprintf(file, "    Ids are only valid for the pack they were generated from, check\n");
+    fprintf(file, "    yep_pack_fingerprint() against %s_FINGERPRINT once after opening it.\n*/\n\n", prefix);
+    fprintf(file, "#ifndef %s_YEP_IDS_H\n#define %s_YEP_IDS_H\n\n", prefix, prefix);
+    fprintf(file, "#include \"libyep.h\"\n\n");
+    fprintf(file, "#define %s_ENTRY_COUNT %uu\n", prefix, count);
+    fprintf(file, "#define %s_FINGERPRINT 0x%016" PRIx64 "ull\n", prefix, yep_pack_fingerprint(pack));
+
+    char (*identifiers)[160] = calloc(count ? count : 1, sizeof(*identifiers));
+    uint32_t *order = malloc((count ? count : 1) * sizeof(uint32_t));
+
+    for(uint32_t i = 0; i < count; i++) {
+        char name[64];
+        identifier(yep_pack_entry(pack, i)->name, name, sizeof(name));
+        snprintf(identifiers[i], sizeof(identifiers[i]), "%s_%s", prefix, name);
+        order[i] = i;
+    }
+
+    // two names can map to the same identifier (a-b.png and a_b.png), all but the first get their id appended
+    sort_identifiers = identifiers;
+    qsort(order, count, sizeof(uint32_t), compare_identifiers);
+    for(uint32_t i = count; i-- > 1;) {
+        if(strcmp(identifiers[order[i]], identifiers[order[i - 1]]) == 0) {
+            char suffixed[160];
+            snprintf(suffixed, sizeof(suffixed), "%.140s_%u", identifiers[order[i]], order[i]);
+            memcpy(identifiers[order[i]], suffixed, sizeof(suffixed));
+        }
+    }
+    free(order);
+
+    for(uint32_t i = 0; i < count; i++) {
+        const struct yep_entry *entry = yep_pack_entry(pack, i);
+        const char *type = datatype_macro(entry->data_type);
+
+        fprintf(file, "\n// %s\n", entry->name);
+        fprintf(file, "#define %s_ID %uu\n", identifiers[i], i);
+        fprintf(file, "#define %s_HASH 0x%016" PRIx64 "ull\n", identifiers[i], yep_hash_handle(entry->name));
+        fprintf(file, "#define %s_SIZE %" PRIu32 "u\n", identifiers[i], entry->uncompressed_size);
+        if(type != NULL)
+            fprintf(file, "#define %s_TYPE %s\n", identifiers[i], type);
+        else
+            fprintf(file, "#define %s_TYPE %u\n", identifiers[i], entry->data_type);
+    }
+
+    fprintf(file, "\n#endif // %s_YEP_IDS_H\n", prefix);
+
+    free(identifiers);
+    yep_pack_close(pack);
+
+    bool ok = fclose(file) == 0;
+    if(ok)
+        yep_logf(yep_log_info, "Wrote id header to %s\n", header_file);
+    else
+        yep_logf(yep_log_error, "Error writing header file %s\n", header_file);
+    return ok;
+}
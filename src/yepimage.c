@@ -0,0 +1,240 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Image payloads (YEP_DATATYPE_IMAGE)
+
+    At pack time images are decoded with SDL_image into tightly packed RGBA8, optionally
+    followed by a box filtered mip chain, behind a small yep_image_header. At runtime the
+    engine parses the header and hands the pixels straight to a texture upload.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include <SDL3/SDL.h>
+
+#ifdef YEP_HAVE_SDL_IMAGE
+    #include <SDL3_image/SDL_image.h>
+#endif
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+static uint32_t mip_dimension(uint32_t base, uint8_t level) {
+    uint32_t value = base >> level;
+    return value ? value : 1;
+}
+
+bool yep_image_parse(const void *data, size_t size, struct yep_image *out) {
+    if(data == NULL || size < sizeof(struct yep_image_header))
+        return false;
+
+    struct yep_image_header header;
+    memcpy(&header, data, sizeof(header));
+
+    if(header.magic != YEP_IMAGE_MAGIC || header.format != YEP_PIXEL_FORMAT_RGBA8 ||
+       header.mip_count == 0 || header.mip_count > YEP_IMAGE_MAX_MIPS) {
+        yep_logf(yep_log_error, "Invalid yep image header\n");
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->width = header.width;
+    out->height = header.height;
+    out->format = header.format;
+    out->mip_count = header.mip_count;
+
+    const uint8_t *pixels = (const uint8_t *)data + sizeof(struct yep_image_header);
+    size_t remaining = size - sizeof(struct yep_image_header);
+
+    for(uint8_t level = 0; level < header.mip_count; level++) {
+        uint32_t width = mip_dimension(header.width, level);
+        uint32_t height = mip_dimension(header.height, level);
+        size_t bytes = (size_t)width * height * 4;
+
+        if(bytes > remaining) {
+            yep_logf(yep_log_error, "Truncated yep image payload\n");
+            return false;
+        }
+
+        out->mips[level].width = width;
+        out->mips[level].height = height;
+        out->mips[level].pixels = pixels;
+
+        pixels += bytes;
+        remaining -= bytes;
+    }
+
+    return true;
+}
+
+/*
+    ================================= PACK STAGE =================================
+*/
+
+bool yep_is_image_path(const char *name) {
+    static const char *extensions[] = { "png", "jpg", "jpeg", "bmp", "tga", "qoi", "gif" };
+
+    const char *dot = strrchr(name, '.');
+    if(dot == NULL || strchr(dot, '/') != NULL)
+        return false;
+
+    char extension[8];
+    size_t i = 0;
+    for(dot++; *dot && i + 1 < sizeof(extension); dot++)
+        extension[i++] = (char)tolower((unsigned char)*dot);
+    extension[i] = '\0';
+
+    for(size_t e = 0; e < sizeof(extensions) / sizeof(extensions[0]); e++) {
+        if(strcmp(extension, extensions[e]) == 0)
+            return true;
+    }
+    return false;
+}
+
+uint8_t yep_image_mip_count(uint32_t width, uint32_t height, bool mips) {
+    if(!mips)
+        return 1;
+
+    uint8_t count = 1;
+    while((width > 1 || height > 1) && count < YEP_IMAGE_MAX_MIPS) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        count++;
+    }
+    return count;
+}
+
+size_t yep_image_payload_size(uint32_t width, uint32_t height, uint8_t mip_count) {
+    size_t size = sizeof(struct yep_image_header);
+    for(uint8_t level = 0; level < mip_count; level++)
+        size += (size_t)mip_dimension(width, level) * mip_dimension(height, level) * 4;
+    return size;
+}
+
+// 2x2 box filter, odd edges clamp to the last row/column
+static void downsample(const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst, uint32_t dst_width, uint32_t dst_height) {
+    for(uint32_t y = 0; y < dst_height; y++) {
+        uint32_t y0 = y * 2 < src_height ? y * 2 : src_height - 1;
+        uint32_t y1 = y0 + 1 < src_height ? y0 + 1 : y0;
+
+        for(uint32_t x = 0; x < dst_width; x++) {
+            uint32_t x0 = x * 2 < src_width ? x * 2 : src_width - 1;
+            uint32_t x1 = x0 + 1 < src_width ? x0 + 1 : x0;
+
+            const uint8_t *a = src + ((size_t)y0 * src_width + x0) * 4;
+            const uint8_t *b = src + ((size_t)y0 * src_width + x1) * 4;
+            const uint8_t *c = src + ((size_t)y1 * src_width + x0) * 4;
+            const uint8_t *d = src + ((size_t)y1 * src_width + x1) * 4;
+            uint8_t *out = dst + ((size_t)y * dst_width + x) * 4;
+
+            for(int channel = 0; channel < 4; channel++)
+                out[channel] = (uint8_t)((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+        }
+    }
+}
+
+bool yep_image_build(const uint8_t *rgba, uint32_t width, uint32_t height, bool mips, char **output, size_t *output_size) {
+    uint8_t mip_count = yep_image_mip_count(width, height, mips);
+    size_t size = yep_image_payload_size(width, height, mip_count);
+
+    char *payload = malloc(size);
+    if(payload == NULL)
+        return false;
+
+    struct yep_image_header header = {
+        .magic = YEP_IMAGE_MAGIC,
+        .width = width,
+        .height = height,
+        .format = YEP_PIXEL_FORMAT_RGBA8,
+        .mip_count = mip_count,
+        .flags = 0,
+        .reserved = 0,
+    };
+    memcpy(payload, &header, sizeof(header));
+
+    uint8_t *level_pixels = (uint8_t *)payload + sizeof(header);
+    memcpy(level_pixels, rgba, (size_t)width * height * 4);
+
+    for(uint8_t level = 1; level < mip_count; level++) {
+        uint32_t src_width = mip_dimension(width, level - 1);
+        uint32_t src_height = mip_dimension(height, level - 1);
+        uint8_t *next = level_pixels + (size_t)src_width * src_height * 4;
+
+        downsample(level_pixels, src_width, src_height, next, mip_dimension(width, level), mip_dimension(height, level));
+        level_pixels = next;
+    }
+
+    *output = payload;
+    *output_size = size;
+    return true;
+}
+
+bool yep_image_decode_rgba(const char *data, size_t size, uint8_t **pixels, uint32_t *width, uint32_t *height) {
+#ifdef YEP_HAVE_SDL_IMAGE
+    SDL_IOStream *stream = SDL_IOFromConstMem(data, size);
+    if(stream == NULL)
+        return false;
+
+    SDL_Surface *surface = IMG_Load_IO(stream, true);
+    if(surface == NULL) {
+        yep_logf(yep_log_warning, "SDL_image could not decode image: %s\n", SDL_GetError());
+        return false;
+    }
+
+    SDL_Surface *rgba = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(surface);
+    if(rgba == NULL) {
+        yep_logf(yep_log_warning, "Could not convert image to RGBA: %s\n", SDL_GetError());
+        return false;
+    }
+
+    *width = (uint32_t)rgba->w;
+    *height = (uint32_t)rgba->h;
+    *pixels = malloc((size_t)rgba->w * rgba->h * 4);
+    if(*pixels == NULL) {
+        yep_logf(yep_log_warning, "Out of memory decoding a %dx%d image\n", rgba->w, rgba->h);
+        SDL_DestroySurface(rgba);
+        return false;
+    }
+
+    // surfaces may have padded rows, we store them tightly packed
+    for(int y = 0; y < rgba->h; y++)
+        memcpy(*pixels + (size_t)y * rgba->w * 4, (const uint8_t *)rgba->pixels + (size_t)y * rgba->pitch, (size_t)rgba->w * 4);
+
+    SDL_DestroySurface(rgba);
+    return true;
+#else
+    (void)data; (void)size; (void)pixels; (void)width; (void)height;
+    return false;
+#endif
+}
+
+bool yep_image_encode(const char *data, size_t size, bool mips, char **output, size_t *output_size) {
+#ifdef YEP_HAVE_SDL_IMAGE
+    uint8_t *pixels;
+    uint32_t width, height;
+    if(!yep_image_decode_rgba(data, size, &pixels, &width, &height))
+        return false;
+
+    bool ok = yep_image_build(pixels, width, height, mips, output, output_size);
+    free(pixels);
+    return ok;
+#else
+    (void)data; (void)size; (void)mips; (void)output; (void)output_size;
+
+    static bool warned = false;
+    if(!warned) {
+        yep_logf(yep_log_warning, "libyep was built without YEP_IMAGE_SUPPORT, images are stored as-is\n");
+        warned = true;
+    }
+    return false;
+#endif
+}
@@ -0,0 +1,286 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+#include <stdio.h>      // for printf, vsnprintf
+#include <stdint.h>     // for uint16_t
+#include <string.h>     // for memcpy
+#include <stdlib.h>     // for malloc, free
+#include <stdarg.h>     // for va_list, va_start, va_end
+
+#include <SDL3/SDL.h>   // threads
+
+#include "yeplog.h"
+
+enum yep_log_level yep_log_threshold = yep_log_info;
+
+static yep_log_sink_fn yep_log_sink = NULL;
+static void *yep_log_sink_userdata = NULL;
+
+// messages longer than this are truncated
+#define YEP_LOG_MESSAGE_MAX 1024
+
+#define YEP_LOG_DEFAULT_RING_SIZE (64 * 1024)
+
+static void _yep_default_sink(enum yep_log_level level, const char *message, void *userdata) {
+    (void)userdata; // unused
+
+    static const char *prefixes[] = {
+        "[DEBUG] ",
+        "[INFO] ",
+        "[WARN] ",
+        "[ERROR] ",
+    };
+
+    if(level < yep_log_debug || level > yep_log_error)
+        return;
+
+    printf("%s%s", prefixes[level], message);
+}
+
+static void _yep_emit(enum yep_log_level level, const char *message) {
+    if(yep_log_sink != NULL)
+        yep_log_sink(level, message, yep_log_sink_userdata);
+    else
+        _yep_default_sink(level, message, NULL);
+}
+
+/*
+    ============================== ASYNC RING BUFFER ==============================
+
+    Records are stored contiguously as [uint8 level][uint16 length][message bytes + '\0'].
+    A record never wraps: if it does not fit before the end of the buffer, a single
+    YEP_LOG_RECORD_WRAP byte is written and the record starts again at offset 0.
+*/
+
+#define YEP_LOG_RECORD_HEADER 3
+#define YEP_LOG_RECORD_WRAP   0xFF
+
+static struct {
+    bool running;
+    bool stopping;
+
+    char *ring;
+    size_t capacity;
+    size_t head;        // next write offset
+    size_t tail;        // next read offset
+    size_t used;        // bytes between tail and head (including wrap padding)
+    size_t dropped;     // messages discarded because the ring was full
+
+    bool draining;      // the worker is currently emitting records outside the lock
+
+    SDL_Thread *thread;
+    SDL_Mutex *lock;
+    SDL_Condition *has_data;
+    SDL_Condition *drained;
+} yep_log_async = {0};
+
+static bool _yep_ring_push(enum yep_log_level level, const char *message, size_t length) {
+    size_t record_size = YEP_LOG_RECORD_HEADER + length + 1;
+
+    // bytes left before the physical end of the buffer
+    size_t contiguous = yep_log_async.capacity - yep_log_async.head;
+    size_t needed = record_size;
+    if(contiguous < record_size)
+        needed += contiguous; // padding to the end, then the record at the start
+
+    if(yep_log_async.used + needed > yep_log_async.capacity)
+        return false;
+
+    if(contiguous < record_size) {
+        yep_log_async.ring[yep_log_async.head] = (char)YEP_LOG_RECORD_WRAP;
+        yep_log_async.used += contiguous;
+        yep_log_async.head = 0;
+    }
+
+    char *record = yep_log_async.ring + yep_log_async.head;
+    uint16_t length16 = (uint16_t)length;
+    record[0] = (char)level;
+    memcpy(record + 1, &length16, sizeof(uint16_t));
+    memcpy(record + YEP_LOG_RECORD_HEADER, message, length + 1);
+
+    yep_log_async.head = (yep_log_async.head + record_size) % yep_log_async.capacity;
+    yep_log_async.used += record_size;
+
+    return true;
+}
+
+static int SDLCALL _yep_log_worker(void *userdata) {
+    (void)userdata; // unused
+
+    char message[YEP_LOG_MESSAGE_MAX];
+
+    SDL_LockMutex(yep_log_async.lock);
+    while(true) {
+        while(yep_log_async.used == 0 && !yep_log_async.stopping)
+            SDL_WaitCondition(yep_log_async.has_data, yep_log_async.lock);
+
+        if(yep_log_async.used == 0 && yep_log_async.stopping)
+            break;
+
+        yep_log_async.draining = true;
+
+        while(yep_log_async.used > 0) {
+            // skip the wrap padding at the end of the buffer
+            if((unsigned char)yep_log_async.ring[yep_log_async.tail] == YEP_LOG_RECORD_WRAP) {
+                yep_log_async.used -= yep_log_async.capacity - yep_log_async.tail;
+                yep_log_async.tail = 0;
+                continue;
+            }
+
+            char *record = yep_log_async.ring + yep_log_async.tail;
+            enum yep_log_level level = (enum yep_log_level)record[0];
+            uint16_t length;
+            memcpy(&length, record + 1, sizeof(uint16_t));
+            memcpy(message, record + YEP_LOG_RECORD_HEADER, (size_t)length + 1);
+
+            size_t record_size = YEP_LOG_RECORD_HEADER + (size_t)length + 1;
+            yep_log_async.tail = (yep_log_async.tail + record_size) % yep_log_async.capacity;
+            yep_log_async.used -= record_size;
+
+            size_t dropped = yep_log_async.dropped;
+            yep_log_async.dropped = 0;
+
+            // never hold the lock while calling into the sink
+            SDL_UnlockMutex(yep_log_async.lock);
+            if(dropped > 0) {
+                char note[96];
+                snprintf(note, sizeof(note), "yep log: dropped %zu messages (ring buffer full)\n", dropped);
+                _yep_emit(yep_log_warning, note);
+            }
+            _yep_emit(level, message);
+            SDL_LockMutex(yep_log_async.lock);
+        }
+
+        yep_log_async.draining = false;
+        SDL_BroadcastCondition(yep_log_async.drained);
+    }
+    SDL_UnlockMutex(yep_log_async.lock);
+
+    return 0;
+}
+
+/*
+    ================================== PUBLIC API =================================
+*/
+
+void yep_log_write(enum yep_log_level level, const char *fmt, ...) {
+    char message[YEP_LOG_MESSAGE_MAX];
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    if(written < 0)
+        return;
+
+    if(!yep_log_async.running) {
+        _yep_emit(level, message);
+        return;
+    }
+
+    size_t length = (size_t)written < sizeof(message) ? (size_t)written : sizeof(message) - 1;
+
+    SDL_LockMutex(yep_log_async.lock);
+    if(_yep_ring_push(level, message, length))
+        SDL_SignalCondition(yep_log_async.has_data);
+    else
+        yep_log_async.dropped++;
+    SDL_UnlockMutex(yep_log_async.lock);
+}
+
+void yep_set_log_level(enum yep_log_level level) {
+    yep_log_threshold = level;
+}
+
+void yep_set_log_sink(yep_log_sink_fn sink, void *userdata) {
+    // make sure nothing queued for the old sink ends up in the new one
+    yep_log_flush();
+
+    yep_log_sink = sink;
+    yep_log_sink_userdata = userdata;
+}
+
+bool yep_log_start_async(size_t buffer_size) {
+    if(yep_log_async.running)
+        return true;
+
+    if(buffer_size == 0)
+        buffer_size = YEP_LOG_DEFAULT_RING_SIZE;
+
+    // one maximum size record must always fit
+    if(buffer_size < 2 * (YEP_LOG_MESSAGE_MAX + YEP_LOG_RECORD_HEADER))
+        buffer_size = 2 * (YEP_LOG_MESSAGE_MAX + YEP_LOG_RECORD_HEADER);
+
+    yep_log_async.ring = malloc(buffer_size);
+    yep_log_async.capacity = buffer_size;
+    yep_log_async.head = 0;
+    yep_log_async.tail = 0;
+    yep_log_async.used = 0;
+    yep_log_async.dropped = 0;
+    yep_log_async.draining = false;
+    yep_log_async.stopping = false;
+
+    yep_log_async.lock = SDL_CreateMutex();
+    yep_log_async.has_data = SDL_CreateCondition();
+    yep_log_async.drained = SDL_CreateCondition();
+
+    if(!yep_log_async.ring || !yep_log_async.lock || !yep_log_async.has_data || !yep_log_async.drained)
+        goto fail;
+
+    yep_log_async.thread = SDL_CreateThread(_yep_log_worker, "yep_log", NULL);
+    if(yep_log_async.thread == NULL)
+        goto fail;
+
+    yep_log_async.running = true;
+    return true;
+
+fail:
+    free(yep_log_async.ring);
+    SDL_DestroyCondition(yep_log_async.drained);
+    SDL_DestroyCondition(yep_log_async.has_data);
+    SDL_DestroyMutex(yep_log_async.lock);
+    memset(&yep_log_async, 0, sizeof(yep_log_async));
+
+    yep_logf(yep_log_error, "yep log: failed to start async logging. %s\n", SDL_GetError());
+    return false;
+}
+
+void yep_log_flush(void) {
+    if(!yep_log_async.running)
+        return;
+
+    SDL_LockMutex(yep_log_async.lock);
+    while(yep_log_async.used > 0 || yep_log_async.draining)
+        SDL_WaitCondition(yep_log_async.drained, yep_log_async.lock);
+    SDL_UnlockMutex(yep_log_async.lock);
+}
+
+void yep_log_stop_async(void) {
+    if(!yep_log_async.running)
+        return;
+
+    SDL_LockMutex(yep_log_async.lock);
+    yep_log_async.stopping = true;
+    SDL_SignalCondition(yep_log_async.has_data);
+    SDL_UnlockMutex(yep_log_async.lock);
+
+    // the worker drains everything before exiting
+    SDL_WaitThread(yep_log_async.thread, NULL);
+
+    if(yep_log_async.dropped > 0) {
+        char note[96];
+        snprintf(note, sizeof(note), "yep log: dropped %zu messages (ring buffer full)\n", yep_log_async.dropped);
+        _yep_emit(yep_log_warning, note);
+    }
+
+    free(yep_log_async.ring);
+    SDL_DestroyCondition(yep_log_async.drained);
+    SDL_DestroyCondition(yep_log_async.has_data);
+    SDL_DestroyMutex(yep_log_async.lock);
+    memset(&yep_log_async, 0, sizeof(yep_log_async));
+}
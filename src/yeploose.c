@@ -0,0 +1,187 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Loose directory backend, see yep_mount_directory()
+
+    A mounted directory is served through the same pack handle as a real pack. Opening it
+    scans the tree into the regular entry index (names sorted like the packer sorts them,
+    so ids match a pack built without stages), and extracting reads the file from disk.
+
+    On Linux an inotify watch on every directory of the tree marks the handle stale once
+    anything changes, so yep_refresh_packs() rebuilds the index. Elsewhere the index is
+    only rebuilt when the handle is reopened, file contents are always read fresh.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+struct loose_scan {
+    size_t root_length;
+    struct yep_loose_file *files;
+    uint32_t count;
+    uint32_t capacity;
+    int watch;
+};
+
+#ifdef __linux__
+    #define LOOSE_WATCH_MASK (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF)
+#endif
+
+static SDL_EnumerationResult SDLCALL scan_callback(void *userdata, const char *dirname, const char *fname) {
+    struct loose_scan *scan = userdata;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%s", dirname, fname);
+
+    SDL_PathInfo info;
+    if(!SDL_GetPathInfo(path, &info))
+        return SDL_ENUM_CONTINUE;
+
+    if(info.type == SDL_PATHTYPE_DIRECTORY) {
+#ifdef __linux__
+        if(scan->watch >= 0)
+            inotify_add_watch(scan->watch, path, LOOSE_WATCH_MASK);
+#endif
+        SDL_EnumerateDirectory(path, scan_callback, scan);
+        return SDL_ENUM_CONTINUE;
+    }
+    if(info.type != SDL_PATHTYPE_FILE)
+        return SDL_ENUM_CONTINUE;
+
+    // same naming rules as the packer: relative, forward slashes, fits the header
+    const char *relative = path + scan->root_length;
+    while(*relative == '/' || *relative == '\\')
+        relative++;
+
+    if(strlen(relative) + 1 > 64 || info.size > UINT32_MAX) {
+        yep_logf(yep_log_warning, "Skipping %s, it could not be packed either\n", path);
+        return SDL_ENUM_CONTINUE;
+    }
+
+    if(scan->count == scan->capacity) {
+        scan->capacity = scan->capacity ? scan->capacity * 2 : 256;
+        scan->files = realloc(scan->files, scan->capacity * sizeof(struct yep_loose_file));
+    }
+
+    struct yep_loose_file *file = &scan->files[scan->count++];
+    memset(file->name, 0, sizeof(file->name));
+    for(size_t i = 0; relative[i]; i++)
+        file->name[i] = relative[i] == '\\' ? '/' : relative[i];
+    file->size = (uint32_t)info.size;
+    file->modify_time = (int64_t)info.modify_time;
+
+    return SDL_ENUM_CONTINUE;
+}
+
+static int compare_files(const void *a, const void *b) {
+    return strcmp(((const struct yep_loose_file *)a)->name, ((const struct yep_loose_file *)b)->name);
+}
+
+bool yep_loose_scan(const char *root, int watch, struct yep_loose_file **files, uint32_t *count) {
+    SDL_PathInfo info;
+    if(!SDL_GetPathInfo(root, &info) || info.type != SDL_PATHTYPE_DIRECTORY) {
+        yep_logf(yep_log_error, "Error: mounted directory %s does not exist\n", root);
+        return false;
+    }
+
+    struct loose_scan scan = {
+        .root_length = strlen(root),
+        .files = NULL,
+        .count = 0,
+        .capacity = 0,
+        .watch = watch,
+    };
+
+#ifdef __linux__
+    if(watch >= 0)
+        inotify_add_watch(watch, root, LOOSE_WATCH_MASK);
+#endif
+
+    SDL_EnumerateDirectory(root, scan_callback, &scan);
+
+    if(scan.count > UINT16_MAX) {
+        yep_logf(yep_log_error, "Error: %s has more files than a pack can hold\n", root);
+        free(scan.files);
+        return false;
+    }
+
+    qsort(scan.files, scan.count, sizeof(struct yep_loose_file), compare_files);
+
+    *files = scan.files;
+    *count = scan.count;
+    return true;
+}
+
+int yep_loose_watch_open(void) {
+#ifdef __linux__
+    return inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+    return -1;
+#endif
+}
+
+bool yep_loose_watch_changed(int watch) {
+#ifdef __linux__
+    // events are never read, the handle stays stale until it is reopened
+    struct pollfd pfd = { .fd = watch, .events = POLLIN, .revents = 0 };
+    return watch >= 0 && poll(&pfd, 1, 0) > 0;
+#else
+    (void)watch;
+    return false;
+#endif
+}
+
+void yep_loose_watch_close(int watch) {
+#ifdef __linux__
+    if(watch >= 0)
+        close(watch);
+#else
+    (void)watch;
+#endif
+}
+
+char *yep_loose_read(const char *root, const char *name, size_t *size) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) {
+        yep_logf(yep_log_warning, "Could not open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0L, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0L, SEEK_SET);
+
+    // null terminated like uncompressed pack entries
+    char *data = length >= 0 ? malloc((size_t)length + 1) : NULL;
+    if(data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        yep_logf(yep_log_warning, "Could not read %s\n", path);
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    data[length] = '\0';
+
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
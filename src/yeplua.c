@@ -0,0 +1,111 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Lua stage (YEP_DATATYPE_LUA_BYTECODE)
+
+    Scripts are compiled at pack time and dumped as bytecode, stripped of debug info unless
+    yep_pack_options.lua_debug_info is set. They are never compressed, so the engine can
+    hand a yep_pack_view() of the entry straight to luaL_loadbufferx(..., "b") without
+    copying, parsing or compiling anything.
+
+    Lua bytecode is only portable between builds of the same Lua version with the same
+    word size and endianness, so the packer has to link the same Lua the engine does.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#ifdef YEP_HAVE_LUA
+    #include <lua.h>
+    #include <lauxlib.h>
+#endif
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+bool yep_is_lua_path(const char *name) {
+    const char *dot = strrchr(name, '.');
+    if(dot == NULL || strchr(dot, '/') != NULL)
+        return false;
+
+    char extension[8];
+    size_t i = 0;
+    for(dot++; *dot && i + 1 < sizeof(extension); dot++)
+        extension[i++] = (char)tolower((unsigned char)*dot);
+    extension[i] = '\0';
+
+    return strcmp(extension, "lua") == 0;
+}
+
+#ifdef YEP_HAVE_LUA
+struct dump_buffer {
+    char *data;
+    size_t size;
+    size_t capacity;
+};
+
+static int dump_writer(lua_State *L, const void *chunk, size_t size, void *userdata) {
+    (void)L;
+    struct dump_buffer *buffer = userdata;
+
+    if(buffer->size + size > buffer->capacity) {
+        while(buffer->size + size > buffer->capacity)
+            buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+
+    memcpy(buffer->data + buffer->size, chunk, size);
+    buffer->size += size;
+    return 0;
+}
+#endif
+
+bool yep_lua_compile(const char *name, const char *data, size_t size, bool strip, char **output, size_t *output_size) {
+#ifdef YEP_HAVE_LUA
+    lua_State *L = luaL_newstate();
+    if(L == NULL)
+        return false;
+
+    // "=name" makes compile errors show the pack handle verbatim. Stripping drops it along with
+    // the line info, so only unstripped bytecode keeps it for runtime errors and stack traces
+    char chunk_name[66];
+    snprintf(chunk_name, sizeof(chunk_name), "=%s", name);
+
+    // refuse input that is already bytecode, it would be passed through unchecked
+    if(luaL_loadbufferx(L, data, size, chunk_name, "t") != LUA_OK) {
+        yep_logf(yep_log_warning, "Could not compile %s, storing source: %s\n", name, lua_tostring(L, -1));
+        lua_close(L);
+        return false;
+    }
+
+    struct dump_buffer buffer = {0};
+    int status = lua_dump(L, dump_writer, &buffer, strip ? 1 : 0);
+    lua_close(L);
+
+    if(status != LUA_OK) {
+        yep_logf(yep_log_warning, "Could not dump bytecode for %s, storing source\n", name);
+        free(buffer.data);
+        return false;
+    }
+
+    *output = buffer.data;
+    *output_size = buffer.size;
+    return true;
+#else
+    (void)name; (void)data; (void)size; (void)strip; (void)output; (void)output_size;
+
+    static bool warned = false;
+    if(!warned) {
+        yep_logf(yep_log_warning, "libyep was built without YEP_LUA_SUPPORT, scripts are stored as source\n");
+        warned = true;
+    }
+    return false;
+#endif
+}
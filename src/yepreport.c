@@ -0,0 +1,214 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    JSON pack report, written when yep_pack_options.report_path is set.
+
+    Every entry records its raw size, stored size, ratio (stored / raw) and the time
+    spent compressing it. The report also aggregates by extension and by data type,
+    and lists the slowest entries to compress.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#define YEP_REPORT_SLOWEST 10
+
+struct yep_report_entry {
+    char name[64];
+    char extension[16];
+    uint32_t raw_size;
+    uint32_t stored_size;
+    uint8_t compression_type;
+    uint8_t data_type;
+    uint64_t compress_ns;
+};
+
+struct yep_report {
+    struct yep_report_entry *entries;
+    size_t count;
+    size_t capacity;
+};
+
+struct yep_report_group {
+    const char *key;
+    uint32_t entries;
+    uint64_t raw_size;
+    uint64_t stored_size;
+    uint64_t compress_ns;
+};
+
+struct yep_report *yep_report_create(void) {
+    return calloc(1, sizeof(struct yep_report));
+}
+
+void yep_report_free(struct yep_report *report) {
+    if(report == NULL)
+        return;
+    free(report->entries);
+    free(report);
+}
+
+// lowercase extension of the last path component, empty if there is none
+static void extension_of(const char *name, char *out, size_t out_size) {
+    const char *base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+
+    const char *dot = strrchr(base, '.');
+    out[0] = '\0';
+    if(dot == NULL || dot == base)
+        return;
+
+    size_t i = 0;
+    for(dot++; *dot && i + 1 < out_size; dot++)
+        out[i++] = (char)tolower((unsigned char)*dot);
+    out[i] = '\0';
+}
+
+void yep_report_add(struct yep_report *report, const char *name, uint32_t raw_size, uint32_t stored_size,
+                    uint8_t compression_type, uint8_t data_type, uint64_t compress_ns) {
+    if(report->count == report->capacity) {
+        report->capacity = report->capacity ? report->capacity * 2 : 256;
+        report->entries = realloc(report->entries, report->capacity * sizeof(struct yep_report_entry));
+    }
+
+    struct yep_report_entry *entry = &report->entries[report->count++];
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    extension_of(name, entry->extension, sizeof(entry->extension));
+    entry->raw_size = raw_size;
+    entry->stored_size = stored_size;
+    entry->compression_type = compression_type;
+    entry->data_type = data_type;
+    entry->compress_ns = compress_ns;
+}
+
+void yep_write_json_string(FILE *file, const char *value) {
+    fputc('"', file);
+    for(; *value; value++) {
+        unsigned char c = (unsigned char)*value;
+        if(c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if(c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+static double ratio(uint64_t stored, uint64_t raw) {
+    return raw ? (double)stored / (double)raw : 1.0;
+}
+
+static void write_group(FILE *file, const struct yep_report_group *group, bool last) {
+    fprintf(file, "    ");
+    yep_write_json_string(file, group->key);
+    fprintf(file, ": {\"entries\": %u, \"raw_bytes\": %" PRIu64 ", \"stored_bytes\": %" PRIu64 ", \"ratio\": %.4f, \"compress_ms\": %.3f}%s\n",
+        group->entries, group->raw_size, group->stored_size, ratio(group->stored_size, group->raw_size),
+        group->compress_ns / 1e6, last ? "" : ",");
+}
+
+static void write_entry(FILE *file, const struct yep_report_entry *entry, const char *indent, bool last) {
+    fprintf(file, "%s{\"name\": ", indent);
+    yep_write_json_string(file, entry->name);
+    fprintf(file, ", \"extension\": ");
+    yep_write_json_string(file, entry->extension);
+    fprintf(file, ", \"type\": \"%s\", \"codec\": \"%s\", \"raw_bytes\": %" PRIu32 ", \"stored_bytes\": %" PRIu32 ", \"ratio\": %.4f, \"compress_ms\": %.3f}%s\n",
+        yep_datatype_name(entry->data_type), yep_compression_name(entry->compression_type),
+        entry->raw_size, entry->stored_size, ratio(entry->stored_size, entry->raw_size),
+        entry->compress_ns / 1e6, last ? "" : ",");
+}
+
+static struct yep_report_group *find_group(struct yep_report_group *groups, size_t *count, const char *key) {
+    for(size_t i = 0; i < *count; i++) {
+        if(strcmp(groups[i].key, key) == 0)
+            return &groups[i];
+    }
+
+    struct yep_report_group *group = &groups[(*count)++];
+    memset(group, 0, sizeof(*group));
+    group->key = key;
+    return group;
+}
+
+static void add_to_group(struct yep_report_group *group, const struct yep_report_entry *entry) {
+    group->entries++;
+    group->raw_size += entry->raw_size;
+    group->stored_size += entry->stored_size;
+    group->compress_ns += entry->compress_ns;
+}
+
+static int compare_slowest(const void *a, const void *b) {
+    uint64_t x = (*(const struct yep_report_entry *const *)a)->compress_ns;
+    uint64_t y = (*(const struct yep_report_entry *const *)b)->compress_ns;
+    return (x < y) - (x > y);
+}
+
+bool yep_report_write(const struct yep_report *report, const char *path, const char *pack_path) {
+    FILE *file = fopen(path, "w");
+    if(file == NULL) {
+        yep_logf(yep_log_error, "Failed to open pack report %s for writing\n", path);
+        return false;
+    }
+
+    size_t count = report->count;
+    struct yep_report_group total = { .key = "total" };
+    struct yep_report_group *by_extension = calloc(count + 1, sizeof(struct yep_report_group));
+    struct yep_report_group *by_type = calloc(count + 1, sizeof(struct yep_report_group));
+    const struct yep_report_entry **slowest = malloc((count + 1) * sizeof(struct yep_report_entry *));
+    size_t extension_count = 0, type_count = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        const struct yep_report_entry *entry = &report->entries[i];
+        add_to_group(&total, entry);
+        add_to_group(find_group(by_extension, &extension_count, entry->extension[0] ? entry->extension : "(none)"), entry);
+        add_to_group(find_group(by_type, &type_count, yep_datatype_name(entry->data_type)), entry);
+        slowest[i] = entry;
+    }
+    qsort(slowest, count, sizeof(struct yep_report_entry *), compare_slowest);
+
+    fprintf(file, "{\n  \"pack\": ");
+    yep_write_json_string(file, pack_path);
+    fprintf(file, ",\n  \"format_version\": %d,\n", YEP_CURRENT_FORMAT_VERSION);
+    fprintf(file, "  \"totals\": {\"entries\": %u, \"raw_bytes\": %" PRIu64 ", \"stored_bytes\": %" PRIu64 ", \"ratio\": %.4f, \"compress_ms\": %.3f},\n",
+        total.entries, total.raw_size, total.stored_size, ratio(total.stored_size, total.raw_size), total.compress_ns / 1e6);
+
+    fprintf(file, "  \"by_extension\": {\n");
+    for(size_t i = 0; i < extension_count; i++)
+        write_group(file, &by_extension[i], i + 1 == extension_count);
+
+    fprintf(file, "  },\n  \"by_type\": {\n");
+    for(size_t i = 0; i < type_count; i++)
+        write_group(file, &by_type[i], i + 1 == type_count);
+
+    size_t slowest_count = count < YEP_REPORT_SLOWEST ? count : YEP_REPORT_SLOWEST;
+    fprintf(file, "  },\n  \"slowest\": [\n");
+    for(size_t i = 0; i < slowest_count; i++)
+        write_entry(file, slowest[i], "    ", i + 1 == slowest_count);
+
+    fprintf(file, "  ],\n  \"entries\": [\n");
+    for(size_t i = 0; i < count; i++)
+        write_entry(file, &report->entries[i], "    ", i + 1 == count);
+    fprintf(file, "  ]\n}\n");
+
+    free(slowest);
+    free(by_type);
+    free(by_extension);
+
+    bool ok = fclose(file) == 0;
+    if(ok)
+        yep_logf(yep_log_info, "Wrote pack report to %s\n", path);
+    else
+        yep_logf(yep_log_error, "Failed to write pack report %s\n", path);
+    return ok;
+}
@@ -0,0 +1,374 @@
+/*
+    This file is a part of yoyoengine. (https://github.com/yoyoengine/yoyoengine)
+    Copyright (C) 2023-2025  Ryan Zmuda
+
+    Licensed under the MIT license. See LICENSE file in the project root for details.
+*/
+
+/*
+    Shared memory index and asset cache, see yep_use_shared_memory()
+
+    Every version of a pack file gets one named segment per host (named after its path,
+    size and modification time), laid out as
+
+        header | entries | hashes | buckets | cache slots | cache data
+
+    The first process to open the pack creates the segment, parses the header table into
+    it and publishes it, everyone else waits for that and maps it read-only in practice.
+    The cache data area is handed out with a shared bump pointer: the first process to
+    extract a compressed entry claims its slot, decompresses into the segment and marks
+    it ready, from then on every process reads the same pages. There is no eviction, once
+    the area is full further entries are simply not shared.
+
+    The pack file itself is already shared through the page cache, so only the parsed
+    index and the decompressed copies need this.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL.h>
+
+#include "libyep.h"
+#include "yep_internal.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#define YEP_SHARED_MAGIC 0x4D485359u // "YSHM"
+#define YEP_SHARED_VERSION 2
+
+// cache data is handed out in blocks so the bump pointer fits an SDL_AtomicInt
+#define YEP_SHARED_BLOCK 64
+
+// how long to wait for another process that is building the index
+#define YEP_SHARED_WAIT_MS 5000
+
+enum {
+    SHARED_BUILDING = 0,
+    SHARED_READY = 1,
+    SHARED_FAILED = 2,
+};
+
+enum {
+    SLOT_EMPTY = 0,
+    SLOT_FILLING = 1,
+    SLOT_READY = 2,
+    SLOT_SKIPPED = 3,       // too large for what was left
+};
+
+struct yep_shared_header {
+    uint32_t magic;
+    uint32_t version;
+    SDL_AtomicInt state;
+    int64_t creator;            // pid of the process building the index
+    uint32_t entry_count;
+    uint32_t bucket_count;
+    uint64_t fingerprint;
+
+    uint64_t entries_offset;
+    uint64_t hashes_offset;
+    uint64_t buckets_offset;
+    uint64_t slots_offset;
+    uint64_t cache_offset;
+    uint64_t cache_blocks;
+
+    SDL_AtomicInt cache_used;   // in blocks
+};
+
+struct yep_shared_slot {
+    SDL_AtomicInt state;
+    uint32_t size;
+    uint64_t offset;            // from the start of the cache data
+};
+
+struct yep_shared {
+    char name[64];
+    uint8_t *base;
+    size_t size;
+    bool creator;
+    bool published;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+};
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void segment_name(const char *path, uint64_t identity, char *out, size_t out_size) {
+    uint64_t hash = yep_hash_handle(path) ^ (identity * 0x9E3779B97F4A7C15ull);
+#ifdef _WIN32
+    snprintf(out, out_size, "Local\\yep-%016llx", (unsigned long long)hash);
+#else
+    snprintf(out, out_size, "/yep-%016llx", (unsigned long long)hash);
+#endif
+}
+
+// creates the segment if it does not exist yet, size is only used when creating
+static bool map_segment(struct yep_shared *shared, size_t size) {
+#ifdef _WIN32
+    // pagefile backed, pages only take memory once something is written to them
+    shared->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                         (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFFu), shared->name);
+    if(shared->mapping == NULL)
+        return false;
+    shared->creator = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    shared->base = MapViewOfFile(shared->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if(shared->base == NULL) {
+        CloseHandle(shared->mapping);
+        return false;
+    }
+
+    // an existing section keeps the size its creator gave it
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(shared->base, &info, sizeof(info));
+    shared->size = info.RegionSize;
+    return true;
+#else
+    int fd = shm_open(shared->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    shared->creator = fd >= 0;
+
+    if(fd >= 0) {
+        // sparse, cache pages only take memory once something is written to them
+        if(ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            shm_unlink(shared->name);
+            return false;
+        }
+    }
+    else {
+        fd = shm_open(shared->name, O_RDWR, 0600);
+        if(fd < 0)
+            return false;
+
+        struct stat info;
+        if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct yep_shared_header)) {
+            close(fd);
+            return false;
+        }
+        size = (size_t)info.st_size;
+    }
+
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+        if(shared->creator)
+            shm_unlink(shared->name);
+        return false;
+    }
+
+    shared->base = base;
+    shared->size = size;
+    return true;
+#endif
+}
+
+// false only if the process that created the segment is known to be gone
+static bool creator_alive(const struct yep_shared_header *header) {
+#ifdef _WIN32
+    // the section goes away with the last handle to it, a crashed creator does not outlive its waiters
+    (void)header;
+    return true;
+#else
+    return header->version != YEP_SHARED_VERSION || header->creator <= 0 || kill((pid_t)header->creator, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+static void unmap_segment(struct yep_shared *shared) {
+#ifdef _WIN32
+    UnmapViewOfFile(shared->base);
+    CloseHandle(shared->mapping);
+#else
+    munmap(shared->base, shared->size);
+#endif
+}
+
+static struct yep_shared_header *header_of(const struct yep_shared *shared) {
+    return (struct yep_shared_header *)shared->base;
+}
+
+static void fill_index(const struct yep_shared *shared, struct yep_shared_index *index) {
+    struct yep_shared_header *header = header_of(shared);
+    index->entries = (struct yep_entry *)(shared->base + header->entries_offset);
+    index->hashes = (uint64_t *)(shared->base + header->hashes_offset);
+    index->buckets = (uint32_t *)(shared->base + header->buckets_offset);
+    index->bucket_mask = header->bucket_count - 1;
+    index->fingerprint = header->fingerprint;
+}
+
+struct yep_shared *yep_shared_open(const char *path, uint64_t identity, uint16_t entry_count, uint32_t bucket_count,
+                                   size_t cache_size, struct yep_shared_index *index) {
+    struct yep_shared *shared = calloc(1, sizeof(struct yep_shared));
+    segment_name(path, identity, shared->name, sizeof(shared->name));
+
+    size_t entries_offset = align_up(sizeof(struct yep_shared_header), 64);
+    size_t hashes_offset = align_up(entries_offset + (size_t)entry_count * sizeof(struct yep_entry), 64);
+    size_t buckets_offset = align_up(hashes_offset + (size_t)entry_count * sizeof(uint64_t), 64);
+    size_t slots_offset = align_up(buckets_offset + (size_t)bucket_count * sizeof(uint32_t), 64);
+    size_t cache_offset = align_up(slots_offset + (size_t)entry_count * sizeof(struct yep_shared_slot), 4096);
+
+    uint64_t cache_blocks = cache_size / YEP_SHARED_BLOCK;
+    if(cache_blocks > INT32_MAX)
+        cache_blocks = INT32_MAX;
+
+    // a segment whose creator died while building is replaced once
+    for(int attempt = 0; attempt < 2; attempt++) {
+        if(!map_segment(shared, cache_offset + (size_t)cache_blocks * YEP_SHARED_BLOCK)) {
+            yep_logf(yep_log_warning, "Could not map shared memory for %s, using a private index\n", path);
+            free(shared);
+            return NULL;
+        }
+
+        struct yep_shared_header *header = header_of(shared);
+
+        if(shared->creator) {
+            // a fresh segment is zeroed, so every slot starts out empty
+            header->magic = YEP_SHARED_MAGIC;
+            header->version = YEP_SHARED_VERSION;
+#ifdef _WIN32
+            header->creator = (int64_t)GetCurrentProcessId();
+#else
+            header->creator = (int64_t)getpid();
+#endif
+            header->entry_count = entry_count;
+            header->bucket_count = bucket_count;
+            header->entries_offset = entries_offset;
+            header->hashes_offset = hashes_offset;
+            header->buckets_offset = buckets_offset;
+            header->slots_offset = slots_offset;
+            header->cache_offset = cache_offset;
+            header->cache_blocks = cache_blocks;
+
+            fill_index(shared, index);
+            memset(index->buckets, 0xFF, (size_t)bucket_count * sizeof(uint32_t));
+            index->ready = false;
+            return shared;
+        }
+
+        Uint64 start = SDL_GetTicks();
+        bool orphaned = false;
+        while(SDL_GetAtomicInt(&header->state) == SHARED_BUILDING && SDL_GetTicks() - start < YEP_SHARED_WAIT_MS) {
+            // the creator may not have written its pid yet, only trust a nonzero one
+            if(!creator_alive(header)) {
+                orphaned = SDL_GetAtomicInt(&header->state) == SHARED_BUILDING;
+                break;
+            }
+            SDL_Delay(1);
+        }
+
+#ifndef _WIN32
+        if(orphaned) {
+            yep_logf(yep_log_warning, "Shared index for %s was left half built, rebuilding it\n", path);
+            unmap_segment(shared);
+            shared->base = NULL;
+            shm_unlink(shared->name);
+            continue;
+        }
+#endif
+
+        if(SDL_GetAtomicInt(&header->state) != SHARED_READY || header->magic != YEP_SHARED_MAGIC ||
+           header->version != YEP_SHARED_VERSION || header->entry_count != entry_count || header->bucket_count != bucket_count) {
+            break;
+        }
+
+        fill_index(shared, index);
+        index->ready = true;
+        shared->published = true;
+        return shared;
+    }
+
+    yep_logf(yep_log_warning, "Shared index for %s is not usable, using a private index\n", path);
+    if(shared->base != NULL)
+        unmap_segment(shared);
+    free(shared);
+    return NULL;
+}
+
+void yep_shared_publish(struct yep_shared *shared, uint64_t fingerprint) {
+    header_of(shared)->fingerprint = fingerprint;
+    SDL_SetAtomicInt(&header_of(shared)->state, SHARED_READY);
+    shared->published = true;
+}
+
+static struct yep_shared_slot *slot_of(const struct yep_shared *shared, uint32_t index) {
+    return (struct yep_shared_slot *)(shared->base + header_of(shared)->slots_offset) + index;
+}
+
+const void *yep_shared_cache_get(const struct yep_shared *shared, uint32_t index, size_t *size) {
+    struct yep_shared_slot *slot = slot_of(shared, index);
+    if(SDL_GetAtomicInt(&slot->state) != SLOT_READY)
+        return NULL;
+
+    *size = slot->size;
+    return shared->base + header_of(shared)->cache_offset + slot->offset;
+}
+
+const void *yep_shared_cache_put(const struct yep_shared *shared, uint32_t index, const void *data, size_t size) {
+    struct yep_shared_header *header = header_of(shared);
+    struct yep_shared_slot *slot = slot_of(shared, index);
+
+    // whoever claims the slot fills it, everyone else keeps their private copy meanwhile
+    if(!SDL_CompareAndSwapAtomicInt(&slot->state, SLOT_EMPTY, SLOT_FILLING))
+        return NULL;
+
+    uint64_t blocks = (size + YEP_SHARED_BLOCK - 1) / YEP_SHARED_BLOCK;
+    if(blocks == 0)
+        blocks = 1;
+
+    int used;
+    do {
+        used = SDL_GetAtomicInt(&header->cache_used);
+        if((uint64_t)used + blocks > header->cache_blocks) {
+            SDL_SetAtomicInt(&slot->state, SLOT_SKIPPED);
+            return NULL;
+        }
+    } while(!SDL_CompareAndSwapAtomicInt(&header->cache_used, used, used + (int)blocks));
+
+    uint8_t *target = shared->base + header->cache_offset + (uint64_t)used * YEP_SHARED_BLOCK;
+    memcpy(target, data, size);
+
+    slot->offset = (uint64_t)used * YEP_SHARED_BLOCK;
+    slot->size = (uint32_t)size;
+    SDL_SetAtomicInt(&slot->state, SLOT_READY);
+    return target;
+}
+
+void yep_shared_close(struct yep_shared *shared) {
+    if(shared == NULL)
+        return;
+
+    // a creator that never published failed to parse the pack, let the waiters fall back
+    if(shared->creator && !shared->published) {
+        SDL_SetAtomicInt(&header_of(shared)->state, SHARED_FAILED);
+#ifndef _WIN32
+        shm_unlink(shared->name);
+#endif
+    }
+
+    unmap_segment(shared);
+    free(shared);
+}
+
+bool yep_shared_unlink(const char *path, uint64_t identity) {
+#ifdef _WIN32
+    // named sections go away with the last process that has them open
+    (void)path; (void)identity;
+    return true;
+#else
+    char name[64];
+    segment_name(path, identity, name, sizeof(name));
+    return shm_unlink(name) == 0;
+#endif
+}